@@ -1,5 +1,9 @@
 #include "ftl.h"
 
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
 //#define FEMU_DEBUG_FTL
 
 /* ======= Forward Declarations (함수 원형 선언) ======= */
@@ -10,9 +14,9 @@ static inline void update_lpn_stats_on_write(struct ssd *ssd, uint64_t lpn);
 
 /* 새로 추가: 주소 체크 / free line / 파라미터 체크 */
 static inline void check_addr(int a, int max);
-static struct line *get_next_free_line_hot(struct ssd *ssd);
-static struct line *get_next_free_line_cold(struct ssd *ssd);
+static struct line *get_next_free_line(struct ssd *ssd, int cls);
 static void check_params(struct ssdparams *spp);
+static void ftl_set_temp_bounds(struct ssd *ssd, uint64_t hot);
 
 /* FTL I/O Path */
 static uint64_t ssd_read(struct ssd *ssd, NvmeRequest *req);
@@ -23,10 +27,22 @@ static uint64_t ssd_trim(struct ssd *ssd, NvmeRequest *req);
 static int do_gc(struct ssd *ssd, bool force);
 // static bool ensure_free_line_hot(struct ssd *ssd);
 // static bool ensure_free_line_cold(struct ssd *ssd);
-static int do_gc_hot(struct ssd *ssd, bool force);
-static int do_gc_cold(struct ssd *ssd, bool force);
+static int do_gc_pool(struct ssd *ssd, int cls, bool force, bool emergency);
 /* 통계 출력 */
 /* print_waf_stats는 ftl.h에 선언돼 있으므로 여기선 선언 X */
+static void print_ch_stats(struct ssd *ssd);
+
+/* I/O trace 기록 */
+static void ftl_trace_open(struct ssd *ssd, const char *path);
+static void ftl_trace_record(struct ssd *ssd, NvmeRequest *req, int poller);
+
+/* GC event log */
+static void ftl_gclog_open(struct ssd *ssd, const char *path);
+static void ftl_gclog_record(struct ssd *ssd, const struct gc_event *ev);
+
+/* 공유 메모리 통계 페이지 */
+static void ftl_stats_open(struct ssd *ssd, const char *path);
+static void ftl_stats_publish(struct ssd *ssd, int64_t now);
 
 /* FTL 메인 쓰레드 */
 static void *ftl_thread(void *arg);
@@ -42,33 +58,94 @@ static void *ftl_thread(void *arg);
 
 /* ===================================================== */
 
+static inline int64_t ftl_mono_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/*
+ * profiler section 전환 (ftl.h의 struct ftl_prof 참고):
+ * 지금까지의 시간을 현재 section에 넘기고 sec로 바꿈. 이전 section을 돌려주며
+ * prof_leave()에 그대로 넘기면 복귀. 꺼져 있으면 -1 (prof_leave도 아무것도 안 함)
+ */
+static inline int prof_enter(struct ssd *ssd, int sec)
+{
+    struct ftl_prof *p = &ssd->prof;
+    uint64_t now;
+    int prev;
+
+    if (!p->on) {
+        return -1;
+    }
+    now = ftl_cycles();
+    prev = p->cur;
+    p->cycles[prev] += now - p->last;
+    p->cnt[sec]++;
+    p->last = now;
+    p->cur = sec;
+    return prev;
+}
+
+static inline void prof_leave(struct ssd *ssd, int prev)
+{
+    struct ftl_prof *p = &ssd->prof;
+    uint64_t now;
+
+    if (prev < 0) {
+        return;
+    }
+    now = ftl_cycles();
+    p->cycles[p->cur] += now - p->last;
+    p->last = now;
+    p->cur = prev;
+}
+
+/* 중첩 없이 section만 바꿀 때 (ftl_thread 최상위) */
+static inline void prof_switch(struct ssd *ssd, int sec)
+{
+    prof_enter(ssd, sec);
+}
+
 static inline int total_free_lines(struct ssd *ssd)
 {
-    return ssd->lm.hot_free_line_cnt + ssd->lm.cold_free_line_cnt;
+    int n = 0;
+
+    for (int c = 0; c < ssd->lm.nr_pools; c++) {
+        n += ssd->lm.pool[c].free_cnt;
+    }
+    return n;
 }
 
-static inline bool should_gc(struct ssd *ssd)
+/* 가장 뜨거운 온도 그룹 = Hot pool */
+static inline line_class_t hot_cls(struct ssd *ssd)
 {
-    return (total_free_lines(ssd) <= ssd->sp.gc_thres_lines);
+    return ssd->nr_temps - 1;
 }
 
-static inline bool should_gc_high(struct ssd *ssd)
+static inline struct line_pool *line_pool(struct ssd *ssd, struct line *line)
 {
-    return (total_free_lines(ssd) <= ssd->sp.gc_thres_lines_high);
+    return &ssd->lm.pool[line->cls];
 }
 
-static inline struct ppa get_maptbl_ent(struct ssd *ssd, uint64_t lpn)
+static inline const char *pool_name(struct ssd *ssd, int cls)
 {
-    return ssd->maptbl[lpn];
+    return ftl_temp_name(ssd->nr_temps, cls);
 }
 
-static inline void set_maptbl_ent(struct ssd *ssd, uint64_t lpn, struct ppa *ppa)
+static inline bool should_gc(struct ssd *ssd)
 {
-    ftl_assert(lpn < ssd->sp.tt_pgs);
-    ssd->maptbl[lpn] = *ppa;
+    return (total_free_lines(ssd) <= ssd->sp.gc_thres_lines);
+}
+
+static inline bool should_gc_high(struct ssd *ssd)
+{
+    return (total_free_lines(ssd) <= ssd->sp.gc_thres_lines_high);
 }
 
-static uint64_t ppa2pgidx(struct ssd *ssd, struct ppa *ppa)
+static inline uint64_t ppa2pgidx(struct ssd *ssd, struct ppa *ppa)
 {
     struct ssdparams *spp = &ssd->sp;
     uint64_t pgidx;
@@ -84,6 +161,72 @@ static uint64_t ppa2pgidx(struct ssd *ssd, struct ppa *ppa)
     return pgidx;
 }
 
+#ifdef FTL_COMPACT_MAP
+/* ppa2pgidx의 역변환 (compact maptbl 에서 struct ppa 가 필요할 때만 사용) */
+static inline struct ppa pgidx2ppa(struct ssd *ssd, uint64_t pgidx)
+{
+    struct ssdparams *spp = &ssd->sp;
+    struct ppa ppa;
+
+    ppa.ppa = 0;
+    ppa.g.pg  = pgidx % spp->pgs_per_blk;
+    pgidx /= spp->pgs_per_blk;
+    ppa.g.blk = pgidx % spp->blks_per_pl;
+    pgidx /= spp->blks_per_pl;
+    ppa.g.pl  = pgidx % spp->pls_per_lun;
+    pgidx /= spp->pls_per_lun;
+    ppa.g.lun = pgidx % spp->luns_per_ch;
+    ppa.g.ch  = pgidx / spp->luns_per_ch;
+
+    return ppa;
+}
+
+static inline struct ppa get_maptbl_ent(struct ssd *ssd, uint64_t lpn)
+{
+    struct ppa ppa;
+    uint32_t pgidx = ssd->maptbl[lpn];
+
+    if (pgidx == UNMAPPED_PGIDX) {
+        ppa.ppa = UNMAPPED_PPA;
+        return ppa;
+    }
+
+    return pgidx2ppa(ssd, pgidx);
+}
+
+static inline void set_maptbl_ent(struct ssd *ssd, uint64_t lpn, struct ppa *ppa)
+{
+    ftl_assert(lpn < ssd->sp.tt_pgs);
+    ssd->maptbl[lpn] = (ppa->ppa == UNMAPPED_PPA) ? UNMAPPED_PGIDX :
+                       (uint32_t)ppa2pgidx(ssd, ppa);
+}
+
+static inline uint64_t get_rmap_ent(struct ssd *ssd, struct ppa *ppa)
+{
+    uint32_t lpn = ssd->rmap[ppa2pgidx(ssd, ppa)];
+
+    return (lpn == INVALID_RMAP_LPN) ? INVALID_LPN : lpn;
+}
+
+/* set rmap[page_no(ppa)] -> lpn */
+static inline void set_rmap_ent(struct ssd *ssd, uint64_t lpn, struct ppa *ppa)
+{
+    uint64_t pgidx = ppa2pgidx(ssd, ppa);
+
+    ssd->rmap[pgidx] = (lpn == INVALID_LPN) ? INVALID_RMAP_LPN : (uint32_t)lpn;
+}
+#else
+static inline struct ppa get_maptbl_ent(struct ssd *ssd, uint64_t lpn)
+{
+    return ssd->maptbl[lpn];
+}
+
+static inline void set_maptbl_ent(struct ssd *ssd, uint64_t lpn, struct ppa *ppa)
+{
+    ftl_assert(lpn < ssd->sp.tt_pgs);
+    ssd->maptbl[lpn] = *ppa;
+}
+
 static inline uint64_t get_rmap_ent(struct ssd *ssd, struct ppa *ppa)
 {
     uint64_t pgidx = ppa2pgidx(ssd, ppa);
@@ -98,46 +241,212 @@ static inline void set_rmap_ent(struct ssd *ssd, uint64_t lpn, struct ppa *ppa)
 
     ssd->rmap[pgidx] = lpn;
 }
+#endif
+
+/* === Greedy victim bucket 관리 === */
+
+/* 닫힌 라인을 현재 ipc에 해당하는 bucket에 넣음 */
+static void bucket_victim_insert(struct ssd *ssd, struct line *line)
+{
+    struct line_pool *pl = line_pool(ssd, line);
+
+    ftl_assert(!line->victim);
+    ftl_assert(line->ipc > 0 && line->ipc <= ssd->sp.pgs_per_line);
+
+    QTAILQ_INSERT_TAIL(&pl->victim_bucket[line->ipc], line, entry);
+    line->victim = true;
+
+    if (line->ipc > pl->victim_max_ipc) {
+        pl->victim_max_ipc = line->ipc;
+    }
+}
+
+static void bucket_victim_remove(struct ssd *ssd, struct line *line)
+{
+    struct line_pool *pl = line_pool(ssd, line);
+
+    ftl_assert(line->victim);
+
+    QTAILQ_REMOVE(&pl->victim_bucket[line->ipc], line, entry);
+    line->victim = false;
+
+    /*
+     * max bucket이 비었으면 아래로 내려가며 다음 max를 찾음.
+     * max는 invalidate 한 번에 최대 1씩만 오르므로 분할상환 O(1).
+     */
+    while (pl->victim_max_ipc > 0 &&
+           QTAILQ_EMPTY(&pl->victim_bucket[pl->victim_max_ipc])) {
+        pl->victim_max_ipc--;
+    }
+}
 
-/* === Hot / Cold victim score 계산 함수  === */
+/* === Greedy / Cost-Benefit victim score 계산 함수  === */
 
-/* Hot: invalid pages 개수(ipc)만으로 Greedy */
-static inline uint64_t hot_line_score(struct ssd *ssd, struct line *line)
+/* Greedy: invalid pages 개수(ipc)만으로 */
+static inline uint64_t greedy_line_score(struct ssd *ssd, struct line *line)
 {
     (void)ssd;
     /* ipc가 클수록 GC 효율 ↑ */
     return (uint64_t)line->ipc;
 }
 
-/* Cold: Score = Age × ipc
- *  - Age  = (현재 host_writes - line->last_update_seq)
+/* Cost-Benefit: Score = Age × ipc
+ *  - Age  = (epoch 시점 host_writes - line->last_update_seq), 최소 1
  *  - ipc  = invalid page count
+ *
+ * Cost-Benefit 원식 Age × ipc / pgs_per_line 에서 분모는 모든 라인에 공통이므로
+ * 정수 곱만으로 순서가 같음 (부동소수점 계산 제거).
+ * epoch 이후에 닫힌 라인은 Age=1 로 보고 ipc 순으로만 비교됨.
  */
-/* Cost-Benefit: Age × ipc / (vpc + ipc) */
-static inline uint64_t cold_line_score(struct ssd *ssd, struct line *line)
+static inline uint64_t cb_line_score(struct ssd *ssd, struct line *line)
 {
-    if (line->cls != LINE_CLASS_COLD) return 0;
-    if (line->ipc == 0) return 0;
-    if (line->last_update_seq == 0) return 0;
+    uint64_t seq = line_pool(ssd, line)->cb_epoch_seq;
+    uint64_t age = (seq > line->last_update_seq) ? (seq - line->last_update_seq) : 1;
 
-    uint64_t seq = ssd->host_writes;
-    uint64_t age = (seq > line->last_update_seq) ? (seq - line->last_update_seq) : 0;
+    return age * (uint64_t)line->ipc;
+}
 
-    if (age == 0) {
-        line->cold_score = 0.0;
-        return 0;
+/* === Cost-Benefit victim heap 관리 (indexed max-heap, pos는 1-based) === */
+
+/* key가 같으면 id가 작은 라인을 우선 → 선택 결과가 항상 결정적 */
+static inline bool cb_victim_gt(struct line *a, struct line *b)
+{
+    if (a->cold_score != b->cold_score) {
+        return a->cold_score > b->cold_score;
+    }
+    return a->id < b->id;
+}
+
+static inline void cb_heap_set(struct line_pool *pl, int i, struct line *line)
+{
+    pl->victim_heap[i] = line;
+    line->pos = i + 1;
+}
+
+static void cb_heap_sift_up(struct line_pool *pl, int i)
+{
+    struct line *line = pl->victim_heap[i];
+
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!cb_victim_gt(line, pl->victim_heap[parent])) {
+            break;
+        }
+        cb_heap_set(pl, i, pl->victim_heap[parent]);
+        i = parent;
+    }
+    cb_heap_set(pl, i, line);
+}
+
+static void cb_heap_sift_down(struct line_pool *pl, int i)
+{
+    struct line *line = pl->victim_heap[i];
+    int n = pl->victim_heap_sz;
+
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= n) {
+            break;
+        }
+        if (child + 1 < n &&
+            cb_victim_gt(pl->victim_heap[child + 1],
+                         pl->victim_heap[child])) {
+            child++;
+        }
+        if (!cb_victim_gt(pl->victim_heap[child], line)) {
+            break;
+        }
+        cb_heap_set(pl, i, pl->victim_heap[child]);
+        i = child;
     }
+    cb_heap_set(pl, i, line);
+}
+
+/* force GC 기준(invalid 25%)을 넘은 닫힌 라인만 heap 후보 */
+static inline bool cb_victim_eligible(struct ssd *ssd, struct line *line)
+{
+    return (uint64_t)line->ipc * 4 >= (uint64_t)ssd->sp.pgs_per_line;
+}
+
+static void cb_victim_insert(struct ssd *ssd, struct line *line)
+{
+    struct line_pool *pl = line_pool(ssd, line);
+
+    ftl_assert(!line->victim && line->pos == 0);
+    ftl_assert(pl->victim_heap_sz < ssd->lm.tt_lines);
+
+    line->cold_score = cb_line_score(ssd, line);
+    line->victim = true;
+    cb_heap_set(pl, pl->victim_heap_sz++, line);
+    cb_heap_sift_up(pl, pl->victim_heap_sz - 1);
+}
+
+static void cb_victim_remove(struct ssd *ssd, struct line *line)
+{
+    struct line_pool *pl = line_pool(ssd, line);
+    int i = line->pos - 1;
+    struct line *last;
+
+    ftl_assert(line->victim && line->pos > 0);
+
+    last = pl->victim_heap[--pl->victim_heap_sz];
+    line->victim = false;
+    line->pos = 0;
+
+    if (last != line) {
+        cb_heap_set(pl, i, last);
+        cb_heap_sift_up(pl, i);
+        cb_heap_sift_down(pl, last->pos - 1);
+    }
+}
 
-    /* ⭐ Cost-Benefit 공식: Age × (1 - Utilization) */
-    int total_pages = ssd->sp.pgs_per_line;
-    double utilization = (double)line->vpc / total_pages;
-    double benefit = 1.0 - utilization;  // Invalid 비율
+/* ipc가 늘어난 라인의 key 갱신 (key는 증가만 하므로 sift-up) */
+static void cb_victim_update(struct ssd *ssd, struct line *line)
+{
+    ftl_assert(line->victim && line->pos > 0);
+
+    line->cold_score = cb_line_score(ssd, line);
+    cb_heap_sift_up(line_pool(ssd, line), line->pos - 1);
+}
+
+/* epoch가 지났으면 모든 key를 현재 시점 Age로 다시 계산하고 heapify (O(n)) */
+static void cb_victim_maybe_rekey(struct ssd *ssd, struct line_pool *pl)
+{
+    int prof;
+
+    if (ssd->host_writes - pl->cb_epoch_seq < COLD_CB_EPOCH_PAGES) {
+        return;
+    }
 
-    /* Score = Age × Benefit × 1000 (정수 변환) */
-    uint64_t score = (uint64_t)(age * benefit * 1000.0);
+    prof = prof_enter(ssd, PROF_DECAY);
+    pl->cb_epoch_seq = ssd->host_writes;
+    for (int i = 0; i < pl->victim_heap_sz; i++) {
+        struct line *line = pl->victim_heap[i];
+        line->cold_score = cb_line_score(ssd, line);
+    }
+    for (int i = pl->victim_heap_sz / 2 - 1; i >= 0; i--) {
+        cb_heap_sift_down(pl, i);
+    }
+    prof_leave(ssd, prof);
+}
+
+/* 닫히는 라인을 pool 정책에 맞는 victim 자료구조에 (CB는 25% 미만이면 밖에 둠) */
+static void victim_insert(struct ssd *ssd, struct line *line)
+{
+    if (line_pool(ssd, line)->policy == GC_POLICY_GREEDY) {
+        bucket_victim_insert(ssd, line);
+    } else if (cb_victim_eligible(ssd, line)) {
+        cb_victim_insert(ssd, line);
+    }
+}
 
-    line->cold_score = (double)score;
-    return score;
+static void victim_remove(struct ssd *ssd, struct line *line)
+{
+    if (line_pool(ssd, line)->policy == GC_POLICY_GREEDY) {
+        bucket_victim_remove(ssd, line);
+    } else {
+        cb_victim_remove(ssd, line);
+    }
 }
 
 static void ssd_init_lines(struct ssd *ssd)
@@ -156,41 +465,69 @@ static void ssd_init_lines(struct ssd *ssd)
     lm->free_line_cnt = 0;
     lm->full_line_cnt = 0;
 
-    /* Hot/Cold 리스트 초기화 */
-    QTAILQ_INIT(&lm->hot_free_line_list);
-    QTAILQ_INIT(&lm->cold_free_line_list);
-
-    lm->hot_free_line_cnt = 0;
-    lm->cold_free_line_cnt = 0;
-    lm->hot_victim_line_cnt = 0;
-    lm->cold_victim_line_cnt = 0;
+    /* 온도 그룹별 pool: Hot은 Greedy ipc bucket (0..pgs_per_line), 나머지는 Cost-Benefit heap */
+    lm->nr_pools = ssd->nr_temps;
+    for (int c = 0; c < lm->nr_pools; c++) {
+        struct line_pool *pl = &lm->pool[c];
+
+        QTAILQ_INIT(&pl->free_list);
+        pl->free_cnt = 0;
+        pl->victim_cnt = 0;
+        pl->policy = c == hot_cls(ssd) ? GC_POLICY_GREEDY : GC_POLICY_CB;
+        pl->victim_bucket = NULL;
+        pl->victim_heap = NULL;
+        if (pl->policy == GC_POLICY_GREEDY) {
+            pl->victim_bucket = g_malloc0(sizeof(line_list_t) *
+                                          (spp->pgs_per_line + 1));
+            for (int i = 0; i <= spp->pgs_per_line; i++) {
+                QTAILQ_INIT(&pl->victim_bucket[i]);
+            }
+        } else {
+            pl->victim_heap = g_malloc0(sizeof(struct line *) * lm->tt_lines);
+        }
+        pl->victim_max_ipc = 0;
+        pl->victim_heap_sz = 0;
+        pl->cb_epoch_seq = 0;
+        pl->lines = 0;
+    }
 
-    /* Hot/Cold 비율: 10% Hot, 90% Cold */
-    int hot_lines = (lm->tt_lines * 2) / 10;
+    /* Hot에 HOT_POOL_PCT%, 나머지는 다른 그룹이 균등하게 (Hot 다음으로 뜨거운 그룹부터) */
+    int hot_lines = (lm->tt_lines * HOT_POOL_PCT) / 100;
+    int other_lines = (lm->tt_lines - hot_lines) / (lm->nr_pools - 1);
 
     for (int i = 0; i < lm->tt_lines; i++) {
         line = &lm->lines[i];
         line->id = i;
         line->ipc = 0;
         line->vpc = 0;
+        line->pos = 0;
+        line->victim = false;
+        line->open = false;
         line->last_update_seq = 0;
-        line->cold_score = 0.0;
+        line->cold_score = 0;
+        line->erase_cnt = 0;
+        line->gc = false;
 
         if (i < hot_lines) {
-            line->cls = LINE_CLASS_HOT;
-            QTAILQ_INSERT_TAIL(&lm->hot_free_line_list, line, entry);
-            lm->hot_free_line_cnt++;
+            line->cls = hot_cls(ssd);
         } else {
-            line->cls = LINE_CLASS_COLD;
-            QTAILQ_INSERT_TAIL(&lm->cold_free_line_list, line, entry);
-            lm->cold_free_line_cnt++;
+            int c = hot_cls(ssd) - 1 - (i - hot_lines) / other_lines;
+            line->cls = c > LINE_CLASS_COLD ? c : LINE_CLASS_COLD;
         }
+        QTAILQ_INSERT_TAIL(&lm->pool[line->cls].free_list, line, entry);
+        lm->pool[line->cls].free_cnt++;
+        lm->pool[line->cls].lines++;
+    }
+    for (int c = 0; c < lm->nr_pools; c++) {
+        lm->pool[c].target = lm->pool[c].lines;
     }
 
-    ftl_log("Line pool initialized: Hot=%d (%.1f%%), Cold=%d (%.1f%%)\n",
-            hot_lines, (double)hot_lines / lm->tt_lines * 100.0,
-            lm->tt_lines - hot_lines, 
-            (double)(lm->tt_lines - hot_lines) / lm->tt_lines * 100.0);
+    for (int c = lm->nr_pools - 1; c >= 0; c--) {
+        ftl_log("Line pool initialized: %s=%d (%.1f%%, %s)\n",
+                pool_name(ssd, c), lm->pool[c].free_cnt,
+                (double)lm->pool[c].free_cnt / lm->tt_lines * 100.0,
+                lm->pool[c].policy == GC_POLICY_CB ? "cost-benefit" : "greedy");
+    }
 }
 
 static void ssd_init_one_write_pointer(struct ssd *ssd,
@@ -209,24 +546,24 @@ static void ssd_init_one_write_pointer(struct ssd *ssd,
     wpp->pl  = 0;
 
     /* 라인이 새로 활성화되는 시점에 Age 기준 시퀀스 기록 */
+    curline->open = true;
     curline->last_update_seq = ssd->host_writes;
-    curline->cold_score = 0.0;
+    curline->cold_score = 0;
 
     check_addr(wpp->blk, spp->blks_per_pl);
 }
 
 static void ssd_init_write_pointers(struct ssd *ssd)
 {
-    struct line *hot_line  = get_next_free_line_hot(ssd);
-    struct line *cold_line = get_next_free_line_cold(ssd);
+    for (int c = ssd->nr_temps - 1; c >= 0; c--) {
+        struct line *line = get_next_free_line(ssd, c);
 
-    if (!hot_line || !cold_line) {
-        ftl_err("Failed to initialize write pointers: not enough lines\n");
-        abort();
+        if (!line) {
+            ftl_err("Failed to initialize write pointers: not enough lines\n");
+            abort();
+        }
+        ssd_init_one_write_pointer(ssd, &ssd->wp_pool[c], line);
     }
-
-    ssd_init_one_write_pointer(ssd, &ssd->wp_hot, hot_line);
-    ssd_init_one_write_pointer(ssd, &ssd->wp_cold, cold_line);
 }
 
 static inline void check_addr(int a, int max)
@@ -304,95 +641,112 @@ static inline void check_addr(int a, int max)
 
 
 
-static struct line *get_next_free_line_hot(struct ssd *ssd)
+/*
+ * free list에서 erase 횟수가 가장 적은 라인 (같으면 앞쪽 = 먼저 반납된 것).
+ * list를 다 훑지만 WP가 라인 하나를 다 채울 때 한 번이라 페이지당 비용은 무시할 수준
+ */
+static struct line *free_line_min_erase(struct line *first)
 {
-    struct line_mgmt *lm = &ssd->lm;
-    struct line *curline = NULL;
+    struct line *best = first;
 
-    /* Hot Pool에서 먼저 시도 */
-    curline = QTAILQ_FIRST(&lm->hot_free_line_list);
-    if (curline) {
-        QTAILQ_REMOVE(&lm->hot_free_line_list, curline, entry);
-        lm->hot_free_line_cnt--;
-        return curline;
+    for (struct line *l = first; l; l = QTAILQ_NEXT(l, entry)) {
+        if (l->erase_cnt < best->erase_cnt) {
+            best = l;
+        }
     }
+    return best;
+}
 
-    /* Cold에서 빌려오기 (최소 3개만 예약) */
-    int min_cold_reserve = 3;
-    
-    if (lm->cold_free_line_cnt > min_cold_reserve) {
-        curline = QTAILQ_FIRST(&lm->cold_free_line_list);
-        if (curline) {
-            QTAILQ_REMOVE(&lm->cold_free_line_list, curline, entry);
-            lm->cold_free_line_cnt--;
-            curline->cls = LINE_CLASS_HOT;
-            
-            ftl_log("[POOL] Borrow line %d from COLD -> HOT (cold_free=%d hot_free=%d)\n",
-                    curline->id, lm->cold_free_line_cnt, lm->hot_free_line_cnt);
-            
-            return curline;
-        }
+static struct line *pool_take_free_line(struct ssd *ssd, int cls)
+{
+    struct line_pool *pl = &ssd->lm.pool[cls];
+    struct line *curline = free_line_min_erase(QTAILQ_FIRST(&pl->free_list));
+
+    if (curline) {
+        QTAILQ_REMOVE(&pl->free_list, curline, entry);
+        pl->free_cnt--;
     }
+    return curline;
+}
 
-    /* Emergency GC */
-    ftl_err("No free lines for HOT! Triggering emergency GC...\n");
-    
-    if (do_gc_hot(ssd, true) == 0) {
-        curline = QTAILQ_FIRST(&lm->hot_free_line_list);
-        if (curline) {
-            QTAILQ_REMOVE(&lm->hot_free_line_list, curline, entry);
-            lm->hot_free_line_cnt--;
-            return curline;
+/*
+ * free line이 reserve개보다 많은 pool에서 하나 빌림: 목표 크기보다 라인이 가장 많이 남는
+ * pool부터 (pool 크기 조정이 꺼져 있거나 같으면 cls에 가까운 온도부터)
+ */
+static struct line *pool_borrow_free_line(struct ssd *ssd, int cls, int reserve)
+{
+    struct line_mgmt *lm = &ssd->lm;
+    struct line *curline;
+    int src = -1;
+
+    for (int d = 1; d < ssd->nr_temps; d++) {
+        for (int k = 0; k < 2; k++) {
+            int c = k ? cls + d : cls - d;
+
+            if (c < 0 || c >= ssd->nr_temps || lm->pool[c].free_cnt <= reserve) {
+                continue;
+            }
+            if (src < 0 || (ssd->pool_resize &&
+                            lm->pool[c].lines - lm->pool[c].target >
+                            lm->pool[src].lines - lm->pool[src].target)) {
+                src = c;
+            }
         }
     }
+    if (src < 0) {
+        return NULL;
+    }
 
-    ftl_err("CRITICAL: No free lines available for HOT!\n");
-    return NULL;
+    curline = pool_take_free_line(ssd, src);
+    curline->cls = cls;
+    lm->pool[src].lines--;
+    lm->pool[cls].lines++;
+    ftl_log("[POOL] Borrow line %d from %s -> %s (%s_free=%d %s_free=%d)\n",
+            curline->id, pool_name(ssd, src), pool_name(ssd, cls),
+            pool_name(ssd, src), lm->pool[src].free_cnt,
+            pool_name(ssd, cls), lm->pool[cls].free_cnt);
+    return curline;
 }
 
-static struct line *get_next_free_line_cold(struct ssd *ssd)
+static struct line *get_next_free_line(struct ssd *ssd, int cls)
 {
-    struct line_mgmt *lm = &ssd->lm;
     struct line *curline = NULL;
 
-    /* Cold Pool에서 먼저 시도 */
-    curline = QTAILQ_FIRST(&lm->cold_free_line_list);
+    /* 자기 pool에서 먼저 시도 */
+    curline = pool_take_free_line(ssd, cls);
     if (curline) {
-        QTAILQ_REMOVE(&lm->cold_free_line_list, curline, entry);
-        lm->cold_free_line_cnt--;
         return curline;
     }
 
-    /* Hot에서 빌려오기 (최소 3개만 예약) */
-    int min_hot_reserve = 3;
-    
-    if (lm->hot_free_line_cnt > min_hot_reserve) {
-        curline = QTAILQ_FIRST(&lm->hot_free_line_list);
-        if (curline) {
-            QTAILQ_REMOVE(&lm->hot_free_line_list, curline, entry);
-            lm->hot_free_line_cnt--;
-            curline->cls = LINE_CLASS_COLD;
-            
-            ftl_log("[POOL] Borrow line %d from HOT -> COLD (hot_free=%d cold_free=%d)\n",
-                    curline->id, lm->hot_free_line_cnt, lm->cold_free_line_cnt);
-            
-            return curline;
-        }
+    /* 온도가 가까운 pool부터 빌려오기 (빌려주는 쪽은 최소 POOL_BORROW_RESERVE개 예약) */
+    curline = pool_borrow_free_line(ssd, cls, POOL_BORROW_RESERVE);
+    if (curline) {
+        return curline;
+    }
+
+    /*
+     * 그래도 없으면 예약분까지 빌림. pool이 많을수록 예약으로 묶이는 라인이 많고,
+     * 아래 emergency GC는 지금 라인을 여는 중인 WP로 relocation이 들어갈 수
+     * 있으므로 정말 남은 라인이 없을 때만
+     */
+    curline = pool_borrow_free_line(ssd, cls, 0);
+    if (curline) {
+        return curline;
     }
 
     /* Emergency GC */
-    ftl_err("No free lines for COLD! Triggering emergency GC...\n");
+    ftl_err("No free lines for %s! Triggering emergency GC...\n",
+            pool_name(ssd, cls));
+    ssd->req_gc_stalled = true;
     
-    if (do_gc_cold(ssd, true) == 0) {
-        curline = QTAILQ_FIRST(&lm->cold_free_line_list);
+    if (do_gc_pool(ssd, cls, true, true) == 0) {
+        curline = pool_take_free_line(ssd, cls);
         if (curline) {
-            QTAILQ_REMOVE(&lm->cold_free_line_list, curline, entry);
-            lm->cold_free_line_cnt--;
             return curline;
         }
     }
 
-    ftl_err("CRITICAL: No free lines available for COLD!\n");
+    ftl_err("CRITICAL: No free lines available for %s!\n", pool_name(ssd, cls));
     return NULL;
 }
 
@@ -479,6 +833,37 @@ static struct line *get_next_free_line_cold(struct ssd *ssd)
 //     return (lm->cold_free_line_cnt > 0);
 // }
 
+static inline bool is_gc_wp(struct ssd *ssd, struct write_pointer *wpp)
+{
+    return wpp >= &ssd->wp_gc[0][0] &&
+           wpp < &ssd->wp_gc[0][0] + FTL_MAX_TEMPS * GC_AGE_GROUPS;
+}
+
+/* class pool에서 free line을 하나 받아 wpp의 새 라인으로 엶; 없으면 false */
+static bool wp_open_next_line(struct ssd *ssd, struct write_pointer *wpp,
+                              line_class_t cls)
+{
+    struct line *line = get_next_free_line(ssd, cls);
+
+    if (!line) {
+        return false;
+    }
+
+    /* 새로 활성화된 라인의 Age 기준점 설정 */
+    wpp->curline = line;
+    wpp->curline->open = true;
+    wpp->curline->last_update_seq = ssd->host_writes;
+    wpp->curline->cold_score = 0;
+
+    wpp->ch = 0;
+    wpp->lun = 0;
+    wpp->pg = 0;
+    wpp->pl = 0;
+    wpp->blk = wpp->curline->id;
+    check_addr(wpp->blk, ssd->sp.blks_per_pl);
+    return true;
+}
+
 static void ssd_advance_write_pointer_class(struct ssd *ssd,
                                             struct write_pointer *wpp,
                                             line_class_t cls)
@@ -502,6 +887,7 @@ static void ssd_advance_write_pointer_class(struct ssd *ssd,
                 struct line *curline = wpp->curline;
 
                 wpp->pg = 0;
+                curline->open = false;
 
                 /* move current line to {victim,full} line list */
                 if (curline->vpc == spp->pgs_per_line) {
@@ -513,29 +899,24 @@ static void ssd_advance_write_pointer_class(struct ssd *ssd,
                 else {
                     ftl_assert(curline->vpc >= 0 && curline->vpc < spp->pgs_per_line);
                     ftl_assert(curline->ipc > 0);
-                    }
+                    /* Greedy pool은 victim bucket, CB pool은 조건 충족 시 heap으로 */
+                    victim_insert(ssd, curline);
+                }
 
-                /* current line is used up, pick another empty line */
-                check_addr(wpp->blk, spp->blks_per_pl);
-                if (cls == LINE_CLASS_HOT) {
-                    wpp->curline = get_next_free_line_hot(ssd);
-                } else {
-                    wpp->curline = get_next_free_line_cold(ssd);
+                /* GC stream은 다음 GC 쓰기 때 새 라인을 엶 (gc_write_pointer) */
+                if (is_gc_wp(ssd, wpp)) {
+                    wpp->curline = NULL;
+                    return;
                 }
 
-                if (!wpp->curline) {
+                /* current line is used up, pick another empty line */
+                check_addr(wpp->blk, spp->blks_per_pl);
+                if (!wp_open_next_line(ssd, wpp, cls)) {
                     ftl_err("No free lines left for class=%d in [%s]\n",
                             cls, ssd->ssdname);
                     abort();    /* TODO: 나중에 Cold→Hot 빌려 쓰기 로직 추가 가능 */
                 }
 
-                /* 새로 활성화된 라인의 Age 기준점 설정 */
-                wpp->curline->last_update_seq = ssd->host_writes;
-                wpp->curline->cold_score = 0.0;
-                
-                wpp->blk = wpp->curline->id;
-                check_addr(wpp->blk, spp->blks_per_pl);
-
                 ftl_assert(wpp->pg == 0);
                 ftl_assert(wpp->lun == 0);
                 ftl_assert(wpp->ch == 0);
@@ -545,16 +926,6 @@ static void ssd_advance_write_pointer_class(struct ssd *ssd,
     }
 }
 
-static void ssd_advance_write_pointer_hot(struct ssd *ssd)
-{
-    ssd_advance_write_pointer_class(ssd, &ssd->wp_hot, LINE_CLASS_HOT);
-}
-
-static void ssd_advance_write_pointer_cold(struct ssd *ssd)
-{
-    ssd_advance_write_pointer_class(ssd, &ssd->wp_cold, LINE_CLASS_COLD);
-}
-
 static struct ppa get_new_page_from_wp(struct ssd *ssd,
                                        struct write_pointer *wpp)
 {
@@ -569,16 +940,6 @@ static struct ppa get_new_page_from_wp(struct ssd *ssd,
     return ppa;
 }
 
-static struct ppa get_new_page_hot(struct ssd *ssd)
-{
-    return get_new_page_from_wp(ssd, &ssd->wp_hot);
-}
-
-static struct ppa get_new_page_cold(struct ssd *ssd)
-{
-    return get_new_page_from_wp(ssd, &ssd->wp_cold);
-}
-
 static void check_params(struct ssdparams *spp)
 {
     /*
@@ -588,6 +949,16 @@ static void check_params(struct ssdparams *spp)
 
     //ftl_assert(is_power_of_2(spp->luns_per_ch));
     //ftl_assert(is_power_of_2(spp->nchs));
+
+    /*
+     * 두 threshold 모두 free line 비율이므로 background(gc_thres_lines) > foreground(high)여야
+     * step ramp와 GC pacing 구간이 생김. 아니면 free line이 high 이하가 되는 즉시 foreground GC
+     */
+    if (spp->gc_thres_lines <= spp->gc_thres_lines_high) {
+        ftl_err("gc_thres_lines %d <= gc_thres_lines_high %d (free lines): background GC "
+                "ramp and GC pacing are disabled\n", spp->gc_thres_lines,
+                spp->gc_thres_lines_high);
+    }
 }
 
 static void ssd_init_params(struct ssdparams *spp, FemuCtrl *n)
@@ -642,67 +1013,46 @@ static void ssd_init_params(struct ssdparams *spp, FemuCtrl *n)
     check_params(spp);
 }
 
-static void ssd_init_nand_page(struct nand_page *pg, struct ssdparams *spp)
+static void ssd_init_nand_lun(struct nand_lun *lun)
 {
-    pg->nsecs = spp->secs_per_pg;
-    pg->sec = g_malloc0(sizeof(nand_sec_status_t) * pg->nsecs);
-    for (int i = 0; i < pg->nsecs; i++) {
-        pg->sec[i] = SEC_FREE;
-    }
-    pg->status = PG_FREE;
+    lun->next_lun_avail_time = 0;
+    lun->busy = false;
+    lun->gc_busy_end = 0;
+    memset(&lun->io, 0, sizeof(lun->io));
 }
 
-static void ssd_init_nand_blk(struct nand_block *blk, struct ssdparams *spp)
+static void ssd_init_ch(struct ssd_channel *ch)
 {
-    blk->npgs = spp->pgs_per_blk;
-    blk->pg = g_malloc0(sizeof(struct nand_page) * blk->npgs);
-    for (int i = 0; i < blk->npgs; i++) {
-        ssd_init_nand_page(&blk->pg[i], spp);
-    }
-    blk->ipc = 0;
-    blk->vpc = 0;
-    blk->erase_cnt = 0;
-    blk->wp = 0;
+    ch->next_ch_avail_time = 0;
+    ch->busy = 0;
 }
 
-static void ssd_init_nand_plane(struct nand_plane *pl, struct ssdparams *spp)
+/* 페이지 상태 비트맵 + 블록 카운터: 할당 몇 번으로 끝 (PG_FREE == 0) */
+static void ssd_init_nand_status(struct ssd *ssd)
 {
-    pl->nblks = spp->blks_per_pl;
-    pl->blk = g_malloc0(sizeof(struct nand_block) * pl->nblks);
-    for (int i = 0; i < pl->nblks; i++) {
-        ssd_init_nand_blk(&pl->blk[i], spp);
-    }
-}
+    struct ssdparams *spp = &ssd->sp;
+    int *cnt;
 
-static void ssd_init_nand_lun(struct nand_lun *lun, struct ssdparams *spp)
-{
-    lun->npls = spp->pls_per_lun;
-    lun->pl = g_malloc0(sizeof(struct nand_plane) * lun->npls);
-    for (int i = 0; i < lun->npls; i++) {
-        ssd_init_nand_plane(&lun->pl[i], spp);
-    }
-    lun->next_lun_avail_time = 0;
-    lun->busy = false;
-}
+    ssd->pg_status = g_malloc0((spp->tt_pgs + PGS_PER_STATUS_BYTE - 1) /
+                               PGS_PER_STATUS_BYTE);
 
-static void ssd_init_ch(struct ssd_channel *ch, struct ssdparams *spp)
-{
-    ch->nluns = spp->luns_per_ch;
-    ch->lun = g_malloc0(sizeof(struct nand_lun) * ch->nluns);
-    for (int i = 0; i < ch->nluns; i++) {
-        ssd_init_nand_lun(&ch->lun[i], spp);
-    }
-    ch->next_ch_avail_time = 0;
-    ch->busy = 0;
+    cnt = g_malloc0(sizeof(int) * spp->tt_blks * 3);
+    ssd->blk.ipc       = cnt;
+    ssd->blk.vpc       = cnt + spp->tt_blks;
+    ssd->blk.erase_cnt = cnt + spp->tt_blks * 2;
 }
 
 static void ssd_init_maptbl(struct ssd *ssd)
 {
     struct ssdparams *spp = &ssd->sp;
 
-    ssd->maptbl = g_malloc0(sizeof(struct ppa) * spp->tt_pgs);
+    ssd->maptbl = g_malloc0(sizeof(ftl_map_ent_t) * spp->tt_pgs);
     for (int i = 0; i < spp->tt_pgs; i++) {
+#ifdef FTL_COMPACT_MAP
+        ssd->maptbl[i] = UNMAPPED_PGIDX;
+#else
         ssd->maptbl[i].ppa = UNMAPPED_PPA;
+#endif
     }
 }
 
@@ -710,9 +1060,13 @@ static void ssd_init_rmap(struct ssd *ssd)
 {
     struct ssdparams *spp = &ssd->sp;
 
-    ssd->rmap = g_malloc0(sizeof(uint64_t) * spp->tt_pgs);
+    ssd->rmap = g_malloc0(sizeof(ftl_rmap_ent_t) * spp->tt_pgs);
     for (int i = 0; i < spp->tt_pgs; i++) {
+#ifdef FTL_COMPACT_MAP
+        ssd->rmap[i] = INVALID_RMAP_LPN;
+#else
         ssd->rmap[i] = INVALID_LPN;
+#endif
     }
 }
 
@@ -725,27 +1079,68 @@ void ssd_init(FemuCtrl *n)
 
     ssd_init_params(spp, n);
 
+#ifdef FTL_COMPACT_MAP
+    /* 32비트 pgidx/LPN 으로 표현 가능한지 확인 (UINT32_MAX는 unmapped 표시용) */
+    if ((uint64_t)spp->tt_pgs >= UINT32_MAX) {
+        ftl_err("FTL_COMPACT_MAP requires tt_pgs < 2^32 (tt_pgs=%d)\n",
+                spp->tt_pgs);
+        abort();
+    }
+#endif
+
     /* WAF 통계 초기화 */
     ssd->host_writes = 0;
     ssd->nand_writes = 0;
     ssd->gc_writes = 0;
+    memset(ssd->pool_host_writes, 0, sizeof(ssd->pool_host_writes));
+    memset(ssd->pool_gc_writes, 0, sizeof(ssd->pool_gc_writes));
+    memset(ssd->pool_gc_cnt, 0, sizeof(ssd->pool_gc_cnt));
+    memset(ssd->pool_erases, 0, sizeof(ssd->pool_erases));
+    ssd->line_erases = 0;
+    ssd->wl_next_check = WL_CHECK_ERASES;
+    ssd->wl_moves = 0;
+    ssd->wl_writes = 0;
+    ssd->gc_job.line = NULL;
 
     /* ===== LPN Hot/Cold 분류용 메타데이터 초기화 ===== */
-    ssd->lpn_state          = g_malloc0(sizeof(lpn_state_t) * spp->tt_pgs);
-    ssd->lpn_access_cnt     = g_malloc0(sizeof(uint32_t)    * spp->tt_pgs);
-    ssd->lpn_last_write_seq = g_malloc0(sizeof(uint64_t)    * spp->tt_pgs);
-    ssd->lpn_short_int_cnt  = g_malloc0(sizeof(uint8_t)     * spp->tt_pgs);
+    ssd->lpn_stats = g_malloc0(sizeof(struct lpn_stat) * spp->tt_pgs);
     ssd->hot_cold_last_decay_seq = 0;
+    ssd->hot_cold_decay_epoch = 0;
+    ssd->hot_cold_decay_window = HOT_DECAY_WINDOW_PAGES;
+    if (ssd->hot_cold_decay_window == 0) {
+        ssd->hot_cold_decay_window = 1;
+    }
     memset(ssd->uid_hist, 0, sizeof(ssd->uid_hist));
-    /*  - g_malloc0 이라서 lpn_state 전부 0(COLD)로 초기화됨
-     *  - access_cnt / last_write_seq / short_int_cnt 도 전부 0
+    memset(ssd->uid_prev, 0, sizeof(ssd->uid_prev));
+    memset(ssd->uid_win, 0, sizeof(ssd->uid_win));
+    ssd->uid_tunes = 0;
+
+    /* FEMU_FTL_TEMPS=2..FTL_MAX_TEMPS : 온도 그룹 (= 라인 pool) 수, 그룹 사이 interval 경계 */
+    ssd->nr_temps = getenv("FEMU_FTL_TEMPS") ? atoi(getenv("FEMU_FTL_TEMPS"))
+                                             : FTL_DEFAULT_TEMPS;
+    ssd->nr_temps = ssd->nr_temps < 2 ? 2 :
+                    ssd->nr_temps > FTL_MAX_TEMPS ? FTL_MAX_TEMPS : ssd->nr_temps;
+    ftl_set_temp_bounds(ssd, HOT_INTERVAL_THRESHOLD_PAGES);
+
+    /* FEMU_FTL_UID_TUNE=0 : Hot 경계를 HOT_INTERVAL_THRESHOLD_PAGES로 고정 */
+    ssd->uid_tune = !getenv("FEMU_FTL_UID_TUNE") ||
+                    atoi(getenv("FEMU_FTL_UID_TUNE")) != 0;
+    ssd->uid_tune_next = UID_TUNE_PAGES;
+    /*  - g_malloc0 이라서 state 전부 0(COLD)로 초기화됨
+     *  - access_cnt / last_seq / short_int 도 전부 0
      */
 
     /* initialize ssd internal layout architecture */
     ssd->ch = g_malloc0(sizeof(struct ssd_channel) * spp->nchs);
     for (int i = 0; i < spp->nchs; i++) {
-        ssd_init_ch(&ssd->ch[i], spp);
+        ssd_init_ch(&ssd->ch[i]);
     }
+    ssd->lun = g_malloc0(sizeof(struct nand_lun) * spp->tt_luns);
+    for (int i = 0; i < spp->tt_luns; i++) {
+        ssd_init_nand_lun(&ssd->lun[i]);
+    }
+    ssd->io_stats_t0 = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
+    ssd_init_nand_status(ssd);
 
     /* initialize maptbl */
     ssd_init_maptbl(ssd);
@@ -759,6 +1154,106 @@ void ssd_init(FemuCtrl *n)
     /* initialize write pointer, this is how we allocate new pages for writes */
     ssd_init_write_pointers(ssd);
 
+    /* latency 히스토그램 */
+    ftl_reset_lat_stats(ssd);
+    ssd->req_gc_stalled = false;
+    ssd->lat_dump_req = 0;
+
+    /* FEMU_FTL_TRACE=<path> 이면 FTL 스레드가 받는 요청을 binary trace로 기록 */
+    ssd->trace = NULL;
+    if (getenv("FEMU_FTL_TRACE")) {
+        ftl_trace_open(ssd, getenv("FEMU_FTL_TRACE"));
+    }
+
+    /* FEMU_FTL_PROF=<ms> 이면 FTL 스레드 시간 분해를 ms마다 출력 */
+    memset(&ssd->prof, 0, sizeof(ssd->prof));
+    ssd->prof_req = -1;
+    if (getenv("FEMU_FTL_PROF")) {
+        ftl_prof_enable(ssd, atoi(getenv("FEMU_FTL_PROF")));
+    }
+
+    /* FEMU_FTL_GC_LOG=<path> 이면 victim마다 GC event 기록, FEMU_FTL_GC_VERBOSE=1 이면 ftl_log도 */
+    ssd->gclog = NULL;
+    if (getenv("FEMU_FTL_GC_LOG")) {
+        ftl_gclog_open(ssd, getenv("FEMU_FTL_GC_LOG"));
+    }
+    ssd->gc_verbose = getenv("FEMU_FTL_GC_VERBOSE") &&
+                      atoi(getenv("FEMU_FTL_GC_VERBOSE")) != 0;
+
+    /* FEMU_FTL_IDLE_GC=<%> : idle 때 gc_thres_lines보다 이만큼 더 free line을 확보 (0이면 끔) */
+    ssd->idle_gc_lines = ssd->sp.tt_lines *
+                         (getenv("FEMU_FTL_IDLE_GC") ? atoi(getenv("FEMU_FTL_IDLE_GC"))
+                                                     : IDLE_GC_DEFAULT_PCT) / 100;
+    ssd->last_req_ns = 0;
+    ssd->idle_gc_cnt = 0;
+    ssd->idle_erase_cnt = 0;
+
+    /* FEMU_FTL_GC_PACE=0 : host 쓰기에 비례한 GC 없이 high 기준에서 line 단위 foreground GC만 */
+    ssd->gc_pace = !getenv("FEMU_FTL_GC_PACE") || atoi(getenv("FEMU_FTL_GC_PACE")) != 0;
+    if (ssd->gc_pace && spp->gc_thres_lines <= spp->gc_thres_lines_high) {
+        ftl_log("GC pacing off: needs gc_thres_lines > gc_thres_lines_high\n");
+        ssd->gc_pace = false;
+    }
+    ssd->gc_pace_credit = 0;
+    ssd->gc_pace_pages = 0;
+    ssd->gc_fg_stalls = 0;
+
+    /* FEMU_FTL_RING_BATCH=<n> : ring에서 한 번에 꺼내는 요청 수 (1이면 예전처럼 하나씩) */
+    ssd->ring_batch = getenv("FEMU_FTL_RING_BATCH") ? atoi(getenv("FEMU_FTL_RING_BATCH"))
+                                                    : FTL_RING_BATCH_DEFAULT;
+    ssd->ring_batch = ssd->ring_batch < 1 ? 1 :
+                      ssd->ring_batch > FTL_RING_BATCH_MAX ? FTL_RING_BATCH_MAX :
+                      ssd->ring_batch;
+
+    /* FEMU_FTL_IDLE_{SPIN,YIELD,SLEEP}_US : ring이 비었을 때 spin → yield → sleep 경계 (ftl.h 참고) */
+    ssd->idle_backoff = !getenv("FEMU_FTL_IDLE_BACKOFF") ||
+                        atoi(getenv("FEMU_FTL_IDLE_BACKOFF")) != 0;
+    ssd->idle_spin_ns = 1000LL * (getenv("FEMU_FTL_IDLE_SPIN_US") ?
+                                  atoi(getenv("FEMU_FTL_IDLE_SPIN_US")) :
+                                  FTL_IDLE_SPIN_US_DEFAULT);
+    ssd->idle_yield_ns = 1000LL * (getenv("FEMU_FTL_IDLE_YIELD_US") ?
+                                   atoi(getenv("FEMU_FTL_IDLE_YIELD_US")) :
+                                   FTL_IDLE_YIELD_US_DEFAULT);
+    ssd->idle_sleep_ns = 1000LL * (getenv("FEMU_FTL_IDLE_SLEEP_US") ?
+                                   atoi(getenv("FEMU_FTL_IDLE_SLEEP_US")) :
+                                   FTL_IDLE_SLEEP_US_DEFAULT);
+    ssd->idle_yield_ns = ssd->idle_yield_ns > ssd->idle_spin_ns ? ssd->idle_yield_ns
+                                                                : ssd->idle_spin_ns;
+    ssd->idle_sleep_ns = ssd->idle_sleep_ns > 0 ? ssd->idle_sleep_ns : 0;
+    ssd->idle_futex = 0;
+    ssd->idle_sleeping = 0;
+    ssd->idle_sleeps = 0;
+    ssd->idle_kicks = 0;
+
+    /* FEMU_FTL_GC_STREAMS=0|1|2 : GC 전용 write pointer 수 (class당) */
+    ssd->gc_streams = getenv("FEMU_FTL_GC_STREAMS") ? atoi(getenv("FEMU_FTL_GC_STREAMS"))
+                                                    : GC_STREAMS_DEFAULT;
+    ssd->gc_streams = ssd->gc_streams < 0 ? 0 :
+                      ssd->gc_streams > GC_AGE_GROUPS ? GC_AGE_GROUPS : ssd->gc_streams;
+    memset(ssd->wp_gc, 0, sizeof(ssd->wp_gc));
+    ssd->gc_wp_opening = false;
+    ssd->gc_age_avg = 0;
+    memset(ssd->gc_stream_writes, 0, sizeof(ssd->gc_stream_writes));
+
+    /* FEMU_FTL_POOL_RESIZE=0 : pool 크기를 처음 비율 그대로 (빌려 쓰기만) */
+    ssd->pool_resize = !getenv("FEMU_FTL_POOL_RESIZE") ||
+                       atoi(getenv("FEMU_FTL_POOL_RESIZE")) != 0;
+    ssd->pool_resize_next = POOL_RESIZE_PAGES;
+    ssd->pool_moves = 0;
+    memset(ssd->pool_host_win, 0, sizeof(ssd->pool_host_win));
+    memset(ssd->pool_moved_win, 0, sizeof(ssd->pool_moved_win));
+    memset(ssd->pool_freed_win, 0, sizeof(ssd->pool_freed_win));
+    memset(ssd->pool_host_prev, 0, sizeof(ssd->pool_host_prev));
+    memset(ssd->pool_gc_prev, 0, sizeof(ssd->pool_gc_prev));
+    memset(ssd->pool_gc_cnt_prev, 0, sizeof(ssd->pool_gc_cnt_prev));
+
+    /* FEMU_FTL_STATS=<path> 이면 통계를 mmap 페이지로 공개 (tools/ftl_stats로 읽음) */
+    ssd->stats_page = NULL;
+    ssd->stats_next_ns = 0;
+    if (getenv("FEMU_FTL_STATS")) {
+        ftl_stats_open(ssd, getenv("FEMU_FTL_STATS"));
+    }
+
     qemu_thread_create(&ssd->ftl_thread, "FEMU-FTL-Thread", ftl_thread, n,
                        QEMU_THREAD_JOINABLE);
 }
@@ -798,20 +1293,22 @@ static inline struct ssd_channel *get_ch(struct ssd *ssd, struct ppa *ppa)
 
 static inline struct nand_lun *get_lun(struct ssd *ssd, struct ppa *ppa)
 {
-    struct ssd_channel *ch = get_ch(ssd, ppa);
-    return &(ch->lun[ppa->g.lun]);
+    return &(ssd->lun[ppa->g.ch * ssd->sp.luns_per_ch + ppa->g.lun]);
 }
 
-static inline struct nand_plane *get_pl(struct ssd *ssd, struct ppa *ppa)
+static inline uint64_t ppa2blkidx(struct ssd *ssd, struct ppa *ppa)
 {
-    struct nand_lun *lun = get_lun(ssd, ppa);
-    return &(lun->pl[ppa->g.pl]);
-}
+    struct ssdparams *spp = &ssd->sp;
+    uint64_t blkidx;
 
-static inline struct nand_block *get_blk(struct ssd *ssd, struct ppa *ppa)
-{
-    struct nand_plane *pl = get_pl(ssd, ppa);
-    return &(pl->blk[ppa->g.blk]);
+    blkidx = ppa->g.ch  * spp->blks_per_ch  + \
+             ppa->g.lun * spp->blks_per_lun + \
+             ppa->g.pl  * spp->blks_per_pl  + \
+             ppa->g.blk;
+
+    ftl_assert(blkidx < spp->tt_blks);
+
+    return blkidx;
 }
 
 static inline struct line *get_line(struct ssd *ssd, struct ppa *ppa)
@@ -819,10 +1316,39 @@ static inline struct line *get_line(struct ssd *ssd, struct ppa *ppa)
     return &(ssd->lm.lines[ppa->g.blk]);
 }
 
-static inline struct nand_page *get_pg(struct ssd *ssd, struct ppa *ppa)
+static inline int get_pg_status(struct ssd *ssd, uint64_t pgidx)
+{
+    int shift = (pgidx % PGS_PER_STATUS_BYTE) * PG_STATUS_BITS;
+
+    return (ssd->pg_status[pgidx / PGS_PER_STATUS_BYTE] >> shift) &
+           PG_STATUS_MASK;
+}
+
+static inline void set_pg_status(struct ssd *ssd, uint64_t pgidx, int status)
+{
+    int shift = (pgidx % PGS_PER_STATUS_BYTE) * PG_STATUS_BITS;
+    uint8_t *byte = &ssd->pg_status[pgidx / PGS_PER_STATUS_BYTE];
+
+    *byte = (*byte & ~(PG_STATUS_MASK << shift)) | (status << shift);
+}
+
+/* ssd_advance_status()에서 명령 하나를 LUN 통계에 반영 (next_lun_avail_time 갱신 후) */
+static inline void lun_io_account(struct nand_lun *lun, int type, int c,
+                                  uint64_t cmd_stime, uint64_t nand_stime)
 {
-    struct nand_block *blk = get_blk(ssd, ppa);
-    return &(blk->pg[ppa->g.pg]);
+    struct nand_io_stats *io = &lun->io;
+
+    io->ops[type][c]++;
+    io->busy_ns[type] += lun->next_lun_avail_time - nand_stime;
+    io->wait_ns[type] += nand_stime - cmd_stime;
+
+    if (type == GC_IO) {
+        lun->gc_busy_end = lun->next_lun_avail_time;
+    } else if (lun->gc_busy_end > cmd_stime) {
+        uint64_t gc_end = (lun->gc_busy_end < nand_stime) ? lun->gc_busy_end :
+                          nand_stime;
+        io->wait_gc_ns += gc_end - cmd_stime;
+    }
 }
 
 static uint64_t ssd_advance_status(struct ssd *ssd, struct ppa *ppa, struct
@@ -843,6 +1369,7 @@ static uint64_t ssd_advance_status(struct ssd *ssd, struct ppa *ppa, struct
                      lun->next_lun_avail_time;
         lun->next_lun_avail_time = nand_stime + spp->pg_rd_lat;
         lat = lun->next_lun_avail_time - cmd_stime;
+        lun_io_account(lun, ncmd->type, c, cmd_stime, nand_stime);
 #if 0
         lun->next_lun_avail_time = nand_stime + spp->pg_rd_lat;
 
@@ -865,6 +1392,7 @@ static uint64_t ssd_advance_status(struct ssd *ssd, struct ppa *ppa, struct
             lun->next_lun_avail_time = nand_stime + spp->pg_wr_lat;
         }
         lat = lun->next_lun_avail_time - cmd_stime;
+        lun_io_account(lun, ncmd->type, c, cmd_stime, nand_stime);
 
 #if 0
         chnl_stime = (ch->next_ch_avail_time < cmd_stime) ? cmd_stime : \
@@ -887,6 +1415,7 @@ static uint64_t ssd_advance_status(struct ssd *ssd, struct ppa *ppa, struct
         lun->next_lun_avail_time = nand_stime + spp->blk_er_lat;
 
         lat = lun->next_lun_avail_time - cmd_stime;
+        lun_io_account(lun, ncmd->type, c, cmd_stime, nand_stime);
         break;
 
     default:
@@ -901,22 +1430,25 @@ static void mark_page_invalid(struct ssd *ssd, struct ppa *ppa)
 {
     struct line_mgmt *lm = &ssd->lm;
     struct ssdparams *spp = &ssd->sp;
-    struct nand_block *blk = NULL;
-    struct nand_page *pg = NULL;
+    uint64_t pgidx = ppa2pgidx(ssd, ppa);
+    uint64_t blkidx = pgidx / spp->pgs_per_blk;
     bool was_full_line = false;
+    bool was_victim = false;
+    struct line_pool *pl;
     struct line *line;
 
-    pg = get_pg(ssd, ppa);
-    ftl_assert(pg->status == PG_VALID);
-    pg->status = PG_INVALID;
+    ftl_assert(get_pg_status(ssd, pgidx) == PG_VALID);
+    set_pg_status(ssd, pgidx, PG_INVALID);
 
-    blk = get_blk(ssd, ppa);
-    ftl_assert(blk->ipc >= 0 && blk->ipc < spp->pgs_per_blk);
-    blk->ipc++;
-    ftl_assert(blk->vpc > 0 && blk->vpc <= spp->pgs_per_blk);
-    blk->vpc--;
+    ftl_assert(ssd->blk.ipc[blkidx] >= 0 &&
+               ssd->blk.ipc[blkidx] < spp->pgs_per_blk);
+    ssd->blk.ipc[blkidx]++;
+    ftl_assert(ssd->blk.vpc[blkidx] > 0 &&
+               ssd->blk.vpc[blkidx] <= spp->pgs_per_blk);
+    ssd->blk.vpc[blkidx]--;
 
     line = get_line(ssd, ppa);
+    pl = line_pool(ssd, line);
     ftl_assert(line->ipc >= 0 && line->ipc < spp->pgs_per_line);
 
     if (line->vpc == spp->pgs_per_line) {
@@ -927,11 +1459,20 @@ static void mark_page_invalid(struct ssd *ssd, struct ppa *ppa)
     /* === Victim 카운트 추적 (최적화) === */
     if (line->ipc == 0) {
         /* 첫 invalid 발생: victim 후보로 추가 */
-        if (line->cls == LINE_CLASS_HOT) {
-            lm->hot_victim_line_cnt++;
-        } else {
-            lm->cold_victim_line_cnt++;
-        }
+        pl->victim_cnt++;
+    }
+
+    /* GC 중인 라인은 어느 자료구조에도 없으므로 카운트만 갱신 */
+    if (line->gc) {
+        line->ipc++;
+        line->vpc--;
+        return;
+    }
+
+    /* bucket에 있던 Greedy 라인은 ipc+1 bucket으로 옮겨야 하므로 일단 뺌 */
+    if (line->victim && pl->policy == GC_POLICY_GREEDY) {
+        bucket_victim_remove(ssd, line);
+        was_victim = true;
     }
 
     line->ipc++;
@@ -942,29 +1483,47 @@ static void mark_page_invalid(struct ssd *ssd, struct ppa *ppa)
         QTAILQ_REMOVE(&lm->full_line_list, line, entry);
         lm->full_line_cnt--;
     }
+
+    /* 닫힌 Greedy 라인이면 (원래 victim이었든 full이었든) bucket에 다시 넣음 */
+    if ((was_victim || was_full_line) && pl->policy == GC_POLICY_GREEDY) {
+        bucket_victim_insert(ssd, line);
+    }
+
+    /* 닫힌 CB 라인: heap에 있으면 key 갱신, 25%를 막 넘었으면 heap에 추가 */
+    if (pl->policy == GC_POLICY_CB && !line->open) {
+        if (line->victim) {
+            cb_victim_update(ssd, line);
+        } else if (cb_victim_eligible(ssd, line)) {
+            cb_victim_insert(ssd, line);
+        }
+    }
 }
 
 static void mark_page_valid(struct ssd *ssd, struct ppa *ppa)
 {
-    struct nand_block *blk = NULL;
-    struct nand_page *pg = NULL;
+    uint64_t pgidx = ppa2pgidx(ssd, ppa);
+    uint64_t blkidx = pgidx / ssd->sp.pgs_per_blk;
     struct line *line;
 
     /* update page status */
-    pg = get_pg(ssd, ppa);
-    ftl_assert(pg->status == PG_FREE);
-    pg->status = PG_VALID;
+    ftl_assert(get_pg_status(ssd, pgidx) == PG_FREE);
+    set_pg_status(ssd, pgidx, PG_VALID);
 
     /* update corresponding block status */
-    blk = get_blk(ssd, ppa);
-    ftl_assert(blk->vpc >= 0 && blk->vpc < ssd->sp.pgs_per_blk);
-    blk->vpc++;
+    ftl_assert(ssd->blk.vpc[blkidx] >= 0 &&
+               ssd->blk.vpc[blkidx] < ssd->sp.pgs_per_blk);
+    ssd->blk.vpc[blkidx]++;
 
     /* update corresponding line status */
     line = get_line(ssd, ppa);
     ftl_assert(line->vpc >= 0 && line->vpc < ssd->sp.pgs_per_line);
     line->vpc++;
 
+    /*
+     * valid page는 WP가 쓰는 열린 라인에만 생기므로 heap 안의 key(Age 기준점)는
+     * 여기서 바뀌지 않음. 라인이 닫힐 때의 last_update_seq가 그대로 key에 쓰임.
+     */
+    ftl_assert(line->open && !line->victim);
     line->last_update_seq = ssd->host_writes;
 
 }
@@ -972,21 +1531,23 @@ static void mark_page_valid(struct ssd *ssd, struct ppa *ppa)
 static void mark_block_free(struct ssd *ssd, struct ppa *ppa)
 {
     struct ssdparams *spp = &ssd->sp;
-    struct nand_block *blk = get_blk(ssd, ppa);
-    struct nand_page *pg = NULL;
+    uint64_t blkidx = ppa2blkidx(ssd, ppa);
+    uint64_t pgidx = blkidx * spp->pgs_per_blk;
 
-    for (int i = 0; i < spp->pgs_per_blk; i++) {
-        /* reset page status */
-        pg = &blk->pg[i];
-        ftl_assert(pg->nsecs == spp->secs_per_pg);
-        pg->status = PG_FREE;
+    /* reset page status: 블록 경계가 byte 경계와 맞으면 memset 한 번 */
+    if (spp->pgs_per_blk % PGS_PER_STATUS_BYTE == 0) {
+        memset(&ssd->pg_status[pgidx / PGS_PER_STATUS_BYTE], 0,
+               spp->pgs_per_blk / PGS_PER_STATUS_BYTE);
+    } else {
+        for (int i = 0; i < spp->pgs_per_blk; i++) {
+            set_pg_status(ssd, pgidx + i, PG_FREE);
+        }
     }
 
     /* reset block status */
-    ftl_assert(blk->npgs == spp->pgs_per_blk);
-    blk->ipc = 0;
-    blk->vpc = 0;
-    blk->erase_cnt++;
+    ssd->blk.ipc[blkidx] = 0;
+    ssd->blk.vpc[blkidx] = 0;
+    ssd->blk.erase_cnt[blkidx]++;
 }
 
 static void gc_read_page(struct ssd *ssd, struct ppa *ppa)
@@ -1002,23 +1563,61 @@ static void gc_read_page(struct ssd *ssd, struct ppa *ppa)
 }
 
 /* move valid page data (already in DRAM) from victim line to a new page */
+/*
+ * GC로 옮길 lpn의 목적지 write pointer: class별 GC stream (gc_streams > 1이면 age로 한 번 더
+ * 나눔). GC 라인을 여는 도중의 중첩 emergency GC처럼 GC 라인을 열 수 없으면 host WP로.
+ */
+static struct write_pointer *gc_write_pointer(struct ssd *ssd, uint64_t lpn,
+                                              line_class_t cls)
+{
+    struct write_pointer *host = &ssd->wp_pool[cls];
+    struct write_pointer *wpp;
+    int grp = 0;
+
+    if (!ssd->gc_streams) {
+        return host;
+    }
+    if (ssd->gc_streams > 1) {
+        uint64_t age = (ssd->host_writes - ssd->lpn_stats[lpn].last_seq) &
+                       LPN_SEQ_MASK;
+
+        grp = age >= ssd->gc_age_avg;
+        ssd->gc_age_avg += (age >> GC_AGE_AVG_SHIFT) -
+                           (ssd->gc_age_avg >> GC_AGE_AVG_SHIFT);
+    }
+
+    wpp = &ssd->wp_gc[cls][grp];
+    if (!wpp->curline) {
+        bool ok;
+
+        if (ssd->gc_wp_opening) {
+            return host;
+        }
+        ssd->gc_wp_opening = true;
+        ok = wp_open_next_line(ssd, wpp, cls);
+        ssd->gc_wp_opening = false;
+        if (!ok) {
+            return host;
+        }
+    }
+    ssd->gc_stream_writes[cls][grp]++;
+    return wpp;
+}
+
 static uint64_t gc_write_page(struct ssd *ssd, struct ppa *old_ppa)
 {
     struct ppa new_ppa;
     struct nand_lun *new_lun;
+    struct write_pointer *wpp;
     uint64_t lpn = get_rmap_ent(ssd, old_ppa);
-    bool is_hot;
+    line_class_t cls;
 
     ftl_assert(valid_lpn(ssd, lpn));
 
-    /* 이 LPN이 현재 Hot인지 보고 GC 이후에도 같은 class에 써줌 */
-    is_hot = ftl_is_lpn_hot(ssd, lpn);
-
-    if (is_hot) {
-        new_ppa = get_new_page_hot(ssd);
-    } else {
-        new_ppa = get_new_page_cold(ssd);
-    }
+    /* 이 LPN의 현재 온도 그룹을 보고 GC 이후에도 같은 pool에 써줌 */
+    cls = ftl_lpn_temp(ssd, lpn);
+    wpp = gc_write_pointer(ssd, lpn, cls);
+    new_ppa = get_new_page_from_wp(ssd, wpp);
 
     /* update maptbl */
     set_maptbl_ent(ssd, lpn, &new_ppa);
@@ -1031,12 +1630,8 @@ static uint64_t gc_write_page(struct ssd *ssd, struct ppa *old_ppa)
     ssd->nand_writes++;
     ssd->gc_writes++;
 
-    /* Hot/Cold에 맞게 write pointer 진행 */
-    if (is_hot) {
-        ssd_advance_write_pointer_hot(ssd);
-    } else {
-        ssd_advance_write_pointer_cold(ssd);
-    }
+    /* 온도 그룹에 맞게 write pointer 진행 */
+    ssd_advance_write_pointer_class(ssd, wpp, cls);
 
     if (ssd->sp.enable_gc_delay) {
         struct nand_cmd gcw;
@@ -1052,271 +1647,813 @@ static uint64_t gc_write_page(struct ssd *ssd, struct ppa *old_ppa)
     return 0;
 }
 
-/* here ppa identifies the block we want to clean */
-static void clean_one_block(struct ssd *ssd, struct ppa *ppa)
+/*
+ * 막 비워진 라인: 소속 pool이 목표보다 크면 목표에 가장 모자란 pool로 넘김.
+ * 소속 pool의 free line이 POOL_BORROW_RESERVE개 이하면 곧 다시 빌려 오게 되므로 (ping-pong) 그대로 둠
+ */
+static void pool_resize_line(struct ssd *ssd, struct line *line)
+{
+    struct line_mgmt *lm = &ssd->lm;
+    int src = line->cls, dst = -1;
+
+    if (!ssd->pool_resize || lm->pool[src].lines <= lm->pool[src].target ||
+        lm->pool[src].free_cnt <= POOL_BORROW_RESERVE) {
+        return;
+    }
+    for (int c = 0; c < lm->nr_pools; c++) {
+        int need = lm->pool[c].target - lm->pool[c].lines;
+
+        if (need > 0 && (dst < 0 || need > lm->pool[dst].target - lm->pool[dst].lines)) {
+            dst = c;
+        }
+    }
+    if (dst < 0) {
+        return;
+    }
+    line->cls = dst;
+    lm->pool[src].lines--;
+    lm->pool[dst].lines++;
+    ssd->pool_moves++;
+}
+
+/* Newton 제곱근 (libm 없이, pool 크기 조정 주기마다 몇 번만 부름) */
+static double pool_sqrt(double x)
+{
+    double r = x > 1.0 ? x : 1.0;
+
+    if (x <= 0.0) {
+        return 0.0;
+    }
+    for (int i = 0; i < 64; i++) {
+        double n = (r + x / r) / 2;
+
+        if (n >= r) {
+            break;
+        }
+        r = n;
+    }
+    return r;
+}
+
+/* pool별 목표 라인 수 다시 계산 (ftl.h의 pool 크기 조정 설명 참고) */
+static void pool_resize(struct ssd *ssd)
 {
     struct ssdparams *spp = &ssd->sp;
-    struct nand_page *pg_iter = NULL;
-    int cnt = 0;
+    struct line_mgmt *lm = &ssd->lm;
+    uint64_t valid[FTL_MAX_TEMPS] = { 0 };
+    double weight[FTL_MAX_TEMPS], wsum = 0.0;
+    uint64_t host = 0;
+    int need[FTL_MAX_TEMPS], spare = lm->tt_lines, left = lm->tt_lines;
+    bool changed = false;
+
+    for (int c = 0; c < lm->nr_pools; c++) {
+        uint64_t gc_lines = ssd->pool_gc_cnt[c] - ssd->pool_gc_cnt_prev[c];
+        uint64_t moved = ssd->pool_gc_writes[c] - ssd->pool_gc_prev[c];
+
+        ssd->pool_host_win[c] = ssd->pool_host_win[c] / 2 +
+                                (ssd->pool_host_writes[c] - ssd->pool_host_prev[c]);
+        ssd->pool_moved_win[c] = ssd->pool_moved_win[c] / 2 + moved;
+        ssd->pool_freed_win[c] = ssd->pool_freed_win[c] / 2 +
+                                 (gc_lines * spp->pgs_per_line - moved);
+        ssd->pool_host_prev[c] = ssd->pool_host_writes[c];
+        ssd->pool_gc_prev[c] = ssd->pool_gc_writes[c];
+        ssd->pool_gc_cnt_prev[c] = ssd->pool_gc_cnt[c];
+        host += ssd->pool_host_win[c];
+    }
+    if (!host) {
+        return;
+    }
+    for (int i = 0; i < lm->tt_lines; i++) {
+        valid[lm->lines[i].cls] += lm->lines[i].vpc;
+    }
+
+    for (int c = 0; c < lm->nr_pools; c++) {
+        struct line_pool *pl = &lm->pool[c];
+        double d = valid[c];
+        uint64_t free_pgs = (uint64_t)pl->lines * spp->pgs_per_line - valid[c];
+
+        /* GC 효율로 본 실효 valid 페이지: 옮긴 / 회수한 × spare (GC가 없었으면 valid 그대로) */
+        if (ssd->pool_freed_win[c]) {
+            d = (double)ssd->pool_moved_win[c] / ssd->pool_freed_win[c] * free_pgs;
+        }
+        need[c] = (valid[c] + spp->pgs_per_line - 1) / spp->pgs_per_line;
+        need[c] = need[c] > POOL_MIN_LINES ? need[c] : POOL_MIN_LINES;
+        spare -= need[c];
+        weight[c] = pool_sqrt((double)ssd->pool_host_win[c] / host * d);
+        wsum += weight[c];
+    }
+    spare = spare > 0 ? spare : 0;
+
+    /* 나머지 (반올림 오차)는 Cold가 가져감 */
+    for (int c = lm->nr_pools - 1; c >= 0; c--) {
+        int t = need[c] + (wsum > 0.0 ? (int)(spare * weight[c] / wsum) : 0);
+
+        t = c == LINE_CLASS_COLD ? left : (t < left ? t : left);
+        left -= t;
+        changed |= t != lm->pool[c].target;
+        lm->pool[c].target = t;
+    }
 
-    for (int pg = 0; pg < spp->pgs_per_blk; pg++) {
-        ppa->g.pg = pg;
-        pg_iter = get_pg(ssd, ppa);
-        /* there shouldn't be any free page in victim blocks */
-        ftl_assert(pg_iter->status != PG_FREE);
-        if (pg_iter->status == PG_VALID) {
-            gc_read_page(ssd, ppa);
-            /* delay the maptbl update until "write" happens */
-            gc_write_page(ssd, ppa);
-            cnt++;
+    if (changed && ssd->gc_verbose) {
+        for (int c = lm->nr_pools - 1; c >= 0; c--) {
+            ftl_log("[POOL] %s target=%d lines=%d (writes %.1f%%, valid %lu pages)\n",
+                    pool_name(ssd, c), lm->pool[c].target, lm->pool[c].lines,
+                    100.0 * ssd->pool_host_win[c] / host, valid[c]);
         }
     }
+}
 
-    ftl_assert(get_blk(ssd, ppa)->vpc == cnt);
+static void ftl_maybe_resize_pools(struct ssd *ssd)
+{
+    if (!ssd->pool_resize || ssd->host_writes < ssd->pool_resize_next) {
+        return;
+    }
+    ssd->pool_resize_next = ssd->host_writes +
+                            (POOL_RESIZE_PAGES ? POOL_RESIZE_PAGES : 1);
+    pool_resize(ssd);
 }
 
 static void mark_line_free(struct ssd *ssd, struct ppa *ppa)
 {
-    struct line_mgmt *lm = &ssd->lm;
     struct line *line = get_line(ssd, ppa);
+    struct line_pool *pl = line_pool(ssd, line);
 
     /* === Victim 카운트 감소 === */
     if (line->ipc > 0) {
-        if (line->cls == LINE_CLASS_HOT) {
-            ftl_assert(lm->hot_victim_line_cnt > 0);
-            lm->hot_victim_line_cnt--;
-        } else {
-            ftl_assert(lm->cold_victim_line_cnt > 0);
-            lm->cold_victim_line_cnt--;
-        }
+        ftl_assert(pl->victim_cnt > 0);
+        pl->victim_cnt--;
     }
 
+    /* victim은 select 시점에 이미 bucket에서 빠져 있어야 함 */
+    ftl_assert(!line->victim);
+
     line->ipc = 0;
     line->vpc = 0;
     line->last_update_seq = 0;
-    line->cold_score = 0.0;
+    line->cold_score = 0;
 
-    /* Free list로 복귀 */
-    if (line->cls == LINE_CLASS_HOT) {
-        QTAILQ_INSERT_TAIL(&lm->hot_free_line_list, line, entry);
-        lm->hot_free_line_cnt++;
-    } else {
-        QTAILQ_INSERT_TAIL(&lm->cold_free_line_list, line, entry);
-        lm->cold_free_line_cnt++;
-    }
+    /* 자기 pool의 free list로 복귀 (pool 크기 조정 중이면 모자란 pool로) */
+    pool_resize_line(ssd, line);
+    pl = line_pool(ssd, line);
+    QTAILQ_INSERT_TAIL(&pl->free_list, line, entry);
+    pl->free_cnt++;
 }
 
-/* Hot victim 선택: invalid가 충분히 많은 HOT 라인만 골라서 GC */
-static struct line *select_victim_line_hot(struct ssd *ssd, bool force)
+/* Greedy victim 선택: invalid가 충분히 많은 라인만 골라서 GC */
+static struct line *select_victim_line_greedy(struct ssd *ssd,
+                                              struct line_pool *pl, bool force)
 {
     struct ssdparams *spp = &ssd->sp;
-    struct line_mgmt *lm = &ssd->lm;
     struct line *best = NULL;
-    uint64_t best_score = 0;
 
     /* 최소 invalid 페이지 수: 라인 전체의 1/8 이상 */
     int min_ipc = spp->pgs_per_line / 8;
 
-    for (int i = 0; i < lm->tt_lines; i++) {
-        struct line *line = &lm->lines[i];
-
-        /* 현재 WP가 사용 중인 라인은 victim에서 제외 */
-        if (line == ssd->wp_hot.curline || line == ssd->wp_cold.curline) {
-            continue;
-        }
-
-        /* HOT 라인만 대상 */
-        if (line->cls != LINE_CLASS_HOT)
-            continue;
+    /*
+     * bucket에는 닫힌 라인 중 ipc > 0 인 것만 들어 있으므로
+     * (WP가 사용 중인 라인은 애초에 없음) 최대 ipc bucket의 첫 라인이 곧 Greedy victim
+     */
+    if (pl->victim_max_ipc == 0) {
+        return NULL;
+    }
 
-        /* invalid 하나도 없으면 스킵 */
-        if (line->ipc == 0)
-            continue;
+    /* 강제 GC가 아닐 때는 invalid가 너무 적은 라인은 건너뜀 */
+    if (!force && pl->victim_max_ipc < min_ipc) {
+        return NULL;
+    }
 
-        /* 강제 GC가 아닐 때는 invalid가 너무 적은 라인은 건너뜀 */
-        if (!force && line->ipc < min_ipc) {
-            continue;
-        }
+    best = QTAILQ_FIRST(&pl->victim_bucket[pl->victim_max_ipc]);
+    ftl_assert(best && greedy_line_score(ssd, best) == pl->victim_max_ipc);
 
-        uint64_t score = hot_line_score(ssd, line);
-        if (score > best_score) {
-            best_score = score;
-            best = line;
-        }
-    }
+    /* GC 도중 중첩 GC가 같은 라인을 다시 고르지 않도록 바로 빼둠 */
+    bucket_victim_remove(ssd, best);
 
     return best;
 }
 
-/* Cold victim 선택: Age × ipc 기반 + 최소 invalid 비율 조건 */
-static struct line *select_victim_line_cold(struct ssd *ssd, bool force)
+/* CB victim 조건: 최소 invalid 비율 25% (force) / 30% (!force), !force면 최소 Age */
+static inline bool cb_victim_ok(struct ssd *ssd, struct line *line, bool force)
 {
-    struct ssdparams *spp = &ssd->sp;
-    struct line_mgmt *lm = &ssd->lm;
-    struct line *victim = NULL;
-    uint64_t max_score = 0;
+    uint64_t ppl = ssd->sp.pgs_per_line;
     uint64_t current_seq = ssd->host_writes;
+    uint64_t min_age_threshold = HOT_DECAY_WINDOW_PAGES / 4;
+    uint64_t age;
 
-    /* 최소 Invalid 비율: 25% (force=true), 30% (force=false) */
-    double min_invalid_ratio = force ? 0.25 : 0.30;
-    uint64_t min_age_threshold = force ? 0 : (HOT_DECAY_WINDOW_PAGES / 4);
-
-    for (int i = 0; i < lm->tt_lines; i++) {
-        struct line *line = &lm->lines[i];
+    if (force) {
+        /* heap에는 25% 이상인 라인만 있음 */
+        return true;
+    }
 
-        if (line->cls != LINE_CLASS_COLD) continue;
-        if (line->vpc == spp->pgs_per_line) continue;
-        if (line->ipc == 0) continue;
-        if (line->last_update_seq == 0) continue;
+    if ((uint64_t)line->ipc * 10 < ppl * 3) {
+        return false;
+    }
 
-        /* ⭐ Invalid 비율 체크 */
-        double invalid_ratio = (double)line->ipc / spp->pgs_per_line;
-        if (invalid_ratio < min_invalid_ratio) continue;
+    age = (current_seq > line->last_update_seq)
+          ? (current_seq - line->last_update_seq) : 0;
 
-        /* Age 계산 */
-        uint64_t age = (current_seq > line->last_update_seq) 
-                       ? (current_seq - line->last_update_seq) : 0;
+    return age >= min_age_threshold;
+}
 
-        if (!force && age < min_age_threshold) continue;
+/*
+ * heap에서 조건을 만족하는 최대 key 라인 찾기.
+ * 자식 key는 부모 이하이므로 조건을 만족하는 노드 아래로는 더 볼 필요가 없고,
+ * 이미 찾은 best보다 작은 subtree도 건너뜀.
+ */
+static struct line *cb_heap_find(struct ssd *ssd, struct line_pool *pl, int i,
+                                 bool force, struct line *best)
+{
+    struct line *line;
 
-        /* Cost-Benefit: Score = Age × Invalid_Ratio */
-        uint64_t score = (uint64_t)(age * invalid_ratio * 1000);
+    if (i >= pl->victim_heap_sz) {
+        return best;
+    }
 
-        /* 조기 종료 (매우 좋은 victim) */
-        if (invalid_ratio >= 0.7 && age > HOT_DECAY_WINDOW_PAGES * 5) {
-            line->cold_score = (double)score;
-            return line;
-        }
+    line = pl->victim_heap[i];
+    if (best && !cb_victim_gt(line, best)) {
+        return best;
+    }
 
-        if (score > max_score) {
-            max_score = score;
-            victim = line;
-        }
+    if (cb_victim_ok(ssd, line, force)) {
+        return line;
     }
 
+    best = cb_heap_find(ssd, pl, 2 * i + 1, force, best);
+    return cb_heap_find(ssd, pl, 2 * i + 2, force, best);
+}
+
+/* CB victim 선택: Age × ipc 기반 + 최소 invalid 비율 조건 */
+static struct line *select_victim_line_cb(struct ssd *ssd,
+                                          struct line_pool *pl, bool force)
+{
+    struct line *victim;
+
+    cb_victim_maybe_rekey(ssd, pl);
+
+    victim = cb_heap_find(ssd, pl, 0, force, NULL);
     if (victim) {
-        victim->cold_score = (double)max_score;
+        /* GC 도중 중첩 GC가 같은 라인을 다시 고르지 않도록 바로 빼둠 */
+        cb_victim_remove(ssd, victim);
     }
 
     return victim;
 }
 
-static int do_gc_for_line(struct ssd *ssd, struct line *victim_line)
+/* pool 하나에서 그 pool의 GC 정책으로 victim 선택 */
+static struct line *select_victim_line_pool(struct ssd *ssd, int cls, bool force)
 {
-    struct ssdparams *spp = &ssd->sp;
-    struct nand_lun *lunp;
-    struct ppa ppa;
-    int ch, lun;
+    struct line_pool *pl = &ssd->lm.pool[cls];
 
-    ppa.g.blk = victim_line->id;
-    ftl_debug("GC-ing line:%d,ipc=%d,hot_victim=%d,cold_victim=%d,"
+    if (pl->policy == GC_POLICY_GREEDY) {
+        return select_victim_line_greedy(ssd, pl, force);
+    }
+    return select_victim_line_cb(ssd, pl, force);
+}
+
+static inline int64_t gc_cpu_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/*
+ * victim을 job에 붙임. victim은 이미 victim 자료구조/full list에서 빠져 있어야 하고,
+ * 이후 host 쓰기로 invalid가 생겨도 line->gc 때문에 다시 들어가지 않음.
+ */
+static void gc_job_start(struct ssd *ssd, struct gc_job *job,
+                         struct line *victim_line, int flags)
+{
+    ftl_assert(!victim_line->victim && !victim_line->open && !victim_line->gc);
+    ftl_debug("GC-ing line:%d,ipc=%d,pool=%s,pool_victim=%d,"
               "full=%d,free_total=%d\n",
-              ppa.g.blk, victim_line->ipc,
-              ssd->lm.hot_victim_line_cnt,
-              ssd->lm.cold_victim_line_cnt,
+              victim_line->id, victim_line->ipc,
+              pool_name(ssd, victim_line->cls),
+              line_pool(ssd, victim_line)->victim_cnt,
               ssd->lm.full_line_cnt,
               total_free_lines(ssd));
 
-    /* copy back valid data */
-    for (ch = 0; ch < spp->nchs; ch++) {
-        for (lun = 0; lun < spp->luns_per_ch; lun++) {
-            ppa.g.ch = ch;
-            ppa.g.lun = lun;
-            ppa.g.pl = 0;
-            lunp = get_lun(ssd, &ppa);
-            clean_one_block(ssd, &ppa);
-            mark_block_free(ssd, &ppa);
-
-            if (spp->enable_gc_delay) {
-                struct nand_cmd gce;
-                gce.type = GC_IO;
-                gce.cmd = NAND_ERASE;
-                gce.stime = 0;
-                ssd_advance_status(ssd, &ppa, &gce);
+    victim_line->gc = true;
+    job->line = victim_line;
+    job->lun = 0;
+    job->pg = 0;
+    job->moved = 0;
+    job->flags = flags;
+
+    if (ssd->gclog) {
+        job->ev.stime = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
+        job->ev.cpu_ns = 0;
+        job->ev.line = victim_line->id;
+        job->ev.ipc = victim_line->ipc;
+        job->ev.vpc = victim_line->vpc;
+        job->ev.cls = victim_line->cls;
+        job->ev.nr_temps = ssd->nr_temps;
+        job->ev.rsvd = 0;
+    }
+}
+
+/* 모든 블록이 지워진 victim을 free list로 돌려놓고 (켜져 있으면) event 기록 */
+static void gc_job_finish(struct ssd *ssd, struct gc_job *job)
+{
+    struct ssdparams *spp = &ssd->sp;
+    struct line *victim_line = job->line;
+    int cls = victim_line->cls;
+    struct ppa ppa;
+
+    ppa.ppa = 0;
+    ppa.g.blk = victim_line->id;
+
+    victim_line->gc = false;
+    victim_line->erase_cnt++;
+    ssd->line_erases++;
+
+    /* update line status (자기 pool의 free list로 복귀) */
+    mark_line_free(ssd, &ppa);
+
+    ssd->pool_gc_writes[cls] += job->moved;
+    ssd->pool_gc_cnt[cls]++;
+    ssd->pool_erases[cls] += spp->tt_luns;
+
+    if (ssd->gclog) {
+        int64_t endtime = 0;
+
+        for (int i = 0; i < spp->tt_luns; i++) {
+            int64_t t = ssd->lun[i].gc_endtime;
+            endtime = (t > endtime) ? t : endtime;
+        }
+        job->ev.emu_ns = endtime > job->ev.stime ? endtime - job->ev.stime : 0;
+        job->ev.moved = job->moved;
+        job->ev.flags = job->flags;
+        ftl_gclog_record(ssd, &job->ev);
+    }
+
+    job->line = NULL;
+}
+
+/*
+ * job의 victim을 최대 budget 페이지만큼 relocate. 마지막 페이지까지 옮기면
+ * 모든 블록을 erase하고 gc_job_finish까지 한 뒤 true.
+ */
+static bool gc_job_step(struct ssd *ssd, struct gc_job *job, int budget)
+{
+    struct ssdparams *spp = &ssd->sp;
+    struct nand_lun *lunp;
+    struct ppa ppa;
+    uint64_t pgidx0 = (uint64_t)job->line->id * spp->pgs_per_blk;
+    int64_t cpu0 = ssd->gclog ? gc_cpu_ns() : 0;
+    int moved = 0;
+    int prof;
+
+    ppa.ppa = 0;
+    ppa.g.blk = job->line->id;
+
+    /* copy back valid data: 페이지 번호 순으로 LUN을 돌아가며 (GC read를 LUN에 고르게) */
+    prof = prof_enter(ssd, PROF_RELOCATE);
+    for (; job->pg < spp->pgs_per_blk && moved < budget; job->pg++, job->lun = 0) {
+        ppa.g.pg = job->pg;
+        for (; job->lun < spp->tt_luns && moved < budget; job->lun++) {
+            /* ppa2pgidx와 같은 값: LUN 사이 간격은 pgs_per_lun으로 일정 */
+            int status = get_pg_status(ssd, pgidx0 + (uint64_t)job->lun *
+                                            spp->pgs_per_lun + job->pg);
+
+            /* there shouldn't be any free page in victim blocks */
+            ftl_assert(status != PG_FREE);
+            if (status == PG_VALID) {
+                ppa.g.ch = job->lun / spp->luns_per_ch;
+                ppa.g.lun = job->lun % spp->luns_per_ch;
+                ftl_assert(ppa2pgidx(ssd, &ppa) == pgidx0 + (uint64_t)job->lun *
+                                                   spp->pgs_per_lun + job->pg);
+                gc_read_page(ssd, &ppa);
+                /* delay the maptbl update until "write" happens */
+                gc_write_page(ssd, &ppa);
+                moved++;
             }
+        }
+        if (job->lun < spp->tt_luns) {
+            break;
+        }
+    }
+    prof_leave(ssd, prof);
+
+    job->moved += moved;
+    if (ssd->gclog) {
+        int64_t t = job->ev.cpu_ns + (gc_cpu_ns() - cpu0);
+        job->ev.cpu_ns = t < UINT32_MAX ? t : UINT32_MAX;
+    }
+    if (job->pg < spp->pgs_per_blk) {
+        return false;
+    }
 
-            lunp->gc_endtime = lunp->next_lun_avail_time;
+    /* 옮긴 페이지도 erase 전까지는 PG_VALID로 남아 있음 (mark_block_free가 한꺼번에 정리) */
+    for (int i = 0; i < spp->tt_luns; i++) {
+        ppa.g.ch = i / spp->luns_per_ch;
+        ppa.g.lun = i % spp->luns_per_ch;
+        ppa.g.pg = 0;
+        lunp = get_lun(ssd, &ppa);
+        mark_block_free(ssd, &ppa);
+
+        if (spp->enable_gc_delay) {
+            struct nand_cmd gce;
+            gce.type = GC_IO;
+            gce.cmd = NAND_ERASE;
+            gce.stime = 0;
+            ssd_advance_status(ssd, &ppa, &gce);
         }
+
+        lunp->gc_endtime = lunp->next_lun_avail_time;
     }
 
-    /* update line status (Hot/Cold free list로 복귀) */
-    mark_line_free(ssd, &ppa);
+    gc_job_finish(ssd, job);
+    return true;
+}
+
+/* victim 하나를 한 번에 GC (foreground / emergency / static WL) */
+static int do_gc_for_line(struct ssd *ssd, struct line *victim_line, int flags)
+{
+    struct gc_job job;
+
+    gc_job_start(ssd, &job, victim_line, flags);
+    /* 라인의 valid 페이지 수는 pgs_per_line을 넘지 않으므로 한 step에 끝남 */
+    gc_job_step(ssd, &job, ssd->sp.pgs_per_line);
 
     return 0;
 }
 
-static int do_gc_hot(struct ssd *ssd, bool force)
+static int do_gc_victim(struct ssd *ssd, struct line *victim_line,
+                        bool force, bool emergency)
 {
-    struct line *victim_line = select_victim_line_hot(ssd, force);
-    if (!victim_line) {
-        return -1;
+    if (ssd->gc_verbose) {
+        ftl_log("[GC] %s: victim line=%d ipc=%d vpc=%d\n",
+                pool_name(ssd, victim_line->cls),
+                victim_line->id, victim_line->ipc, victim_line->vpc);
     }
-    ftl_log("[GC] HOT: victim line=%d ipc=%d vpc=%d\n", victim_line->id, victim_line->ipc, victim_line->vpc);
-    return do_gc_for_line(ssd, victim_line);
+    return do_gc_for_line(ssd, victim_line,
+                          (force ? GC_EV_FORCE : 0) |
+                          (emergency ? GC_EV_EMERGENCY : 0));
 }
 
-static int do_gc_cold(struct ssd *ssd, bool force)
+static int do_gc_pool(struct ssd *ssd, int cls, bool force, bool emergency)
 {
-    struct line *victim_line = select_victim_line_cold(ssd, force);
+    int prof = prof_enter(ssd, PROF_VICTIM);
+    struct line *victim_line = select_victim_line_pool(ssd, cls, force);
+
+    prof_leave(ssd, prof);
     if (!victim_line) {
         return -1;
     }
-    ftl_log("[GC] COLD: victim line=%d ipc=%d vpc=%d\n", victim_line->id, victim_line->ipc, victim_line->vpc);
-    return do_gc_for_line(ssd, victim_line);
+    return do_gc_victim(ssd, victim_line, force, emergency);
 }
 
-static int do_gc(struct ssd *ssd, bool force)
+/*
+ * 아주 단순한 정책:
+ *  - free line이 가장 적은 pool의 victim부터 (같으면 더 뜨거운 pool 먼저)
+ *  - 없으면 다음으로 부족한 pool
+ *  (나중에: 둘 다 위험하면 기준 낮춰 양쪽 다 GC 같은 정책을 여기에.)
+ * order[]에 victim을 찾아볼 pool 순서를 채우고 pool 수를 반환.
+ */
+static int gc_pool_order(struct ssd *ssd, int *order)
 {
     struct line_mgmt *lm = &ssd->lm;
+    int n = 0;
 
-    int hot_free  = lm->hot_free_line_cnt;
-    int cold_free = lm->cold_free_line_cnt;
+    /* free_cnt 오름차순 삽입 정렬 (pool은 최대 FTL_MAX_TEMPS개) */
+    for (int c = lm->nr_pools - 1; c >= 0; c--) {
+        int i = n++;
 
-    /* 아주 단순한 정책:
-     *  - Hot 풀이 더 위험하게 부족하면 Hot GC 우선
-     *  - 아니면 Cold GC 실행
-     *  (나중에: 둘 다 위험하면 기준 낮춰 양쪽 다 GC 같은 정책을 여기에.)
-     */
-    if (hot_free <= cold_free) {
-        if (do_gc_hot(ssd, force) == 0) {
-            return 0;
-        }
-        return do_gc_cold(ssd, force);
-    } else {
-        if (do_gc_cold(ssd, force) == 0) {
-            return 0;
+        while (i > 0 && lm->pool[order[i - 1]].free_cnt > lm->pool[c].free_cnt) {
+            order[i] = order[i - 1];
+            i--;
         }
-        return do_gc_hot(ssd, force);
+        order[i] = c;
     }
+    return n;
 }
 
-static uint64_t ssd_read(struct ssd *ssd, NvmeRequest *req)
+static struct line *select_victim_line(struct ssd *ssd, bool force)
 {
-    struct ssdparams *spp = &ssd->sp;
-    uint64_t lba = req->slba;
-    int nsecs = req->nlb;
-    struct ppa ppa;
-    uint64_t start_lpn = lba / spp->secs_per_pg;
-    uint64_t end_lpn = (lba + nsecs - 1) / spp->secs_per_pg;
-    uint64_t lpn;
-    uint64_t sublat, maxlat = 0;
+    int prof = prof_enter(ssd, PROF_VICTIM);
+    struct line *victim_line = NULL;
+    int order[FTL_MAX_TEMPS];
+    int n = gc_pool_order(ssd, order);
 
-    if (start_lpn >= spp->tt_pgs) {
-    ftl_err("IO beyond device capacity: start_lpn=%"PRIu64", tt_pgs=%d\n",
-            start_lpn, spp->tt_pgs);
-    return 0;
+    for (int i = 0; i < n && !victim_line; i++) {
+        victim_line = select_victim_line_pool(ssd, order[i], force);
     }
+    prof_leave(ssd, prof);
 
-    if (end_lpn >= spp->tt_pgs) {
-        ftl_err("Clamping IO: start_lpn=%"PRIu64", end_lpn=%"PRIu64", tt_pgs=%d\n",
-                start_lpn, end_lpn, spp->tt_pgs);
-        end_lpn = spp->tt_pgs - 1;
+    return victim_line;
+}
+
+static int do_gc(struct ssd *ssd, bool force)
+{
+    struct line *victim_line = select_victim_line(ssd, force);
+
+    if (!victim_line) {
+        return -1;
     }
+    return do_gc_victim(ssd, victim_line, force, false);
+}
 
-    /* normal IO read path */
-    for (lpn = start_lpn; lpn <= end_lpn; lpn++) {
-        ppa = get_maptbl_ent(ssd, lpn);
-        if (!mapped_ppa(&ppa) || !valid_ppa(ssd, &ppa)) {
+/* free line 수에 따른 background GC step 크기 (0이면 이번에는 GC 안 함) */
+static int gc_step_budget(struct ssd *ssd)
+{
+    int free_lines = total_free_lines(ssd);
+    int start = ssd->sp.gc_thres_lines;         /* 여기서부터 background GC */
+    int full = ssd->sp.gc_thres_lines_high;     /* 여기부터는 foreground GC */
+
+    if (free_lines > start) {
+        /* 이미 시작한 victim은 천천히라도 마저 비움 */
+        return ssd->gc_job.line ? GC_STEP_MIN_PAGES : 0;
+    }
+    if (free_lines <= full || start <= full) {
+        return GC_STEP_MAX_PAGES;
+    }
+    return GC_STEP_MIN_PAGES + (GC_STEP_MAX_PAGES - GC_STEP_MIN_PAGES) *
+           (start - free_lines) / (start - full);
+}
+
+/* 모든 LUN이 쉬게 되는 시각 */
+static int64_t nand_idle_at(struct ssd *ssd)
+{
+    int64_t t = 0;
+
+    for (int i = 0; i < ssd->sp.tt_luns; i++) {
+        int64_t avail = ssd->lun[i].next_lun_avail_time;
+        t = avail > t ? avail : t;
+    }
+    return t;
+}
+
+/* valid page가 하나도 없는 victim: relocate 없이 erase만 하면 됨 */
+static struct line *select_victim_line_empty(struct ssd *ssd)
+{
+    struct line_mgmt *lm = &ssd->lm;
+    struct line *line;
+
+    for (int c = lm->nr_pools - 1; c >= 0; c--) {
+        struct line_pool *pl = &lm->pool[c];
+
+        if (pl->policy == GC_POLICY_GREEDY) {
+            if (pl->victim_max_ipc == ssd->sp.pgs_per_line) {
+                line = QTAILQ_FIRST(&pl->victim_bucket[pl->victim_max_ipc]);
+                bucket_victim_remove(ssd, line);
+                return line;
+            }
+            continue;
+        }
+        /* heap은 Age × ipc 순이라 vpc == 0 인 라인이 위에 있다는 보장이 없음 */
+        for (int i = 0; i < pl->victim_heap_sz; i++) {
+            line = pl->victim_heap[i];
+            if (line->vpc == 0) {
+                cb_victim_remove(ssd, line);
+                return line;
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * ring이 비어 있을 때 부름 (now = 현재 시각). 요청이 IDLE_GC_DELAY_NS 동안 없었고
+ * NAND도 쉬고 있을 때만 LUN당 한 페이지 분량의 step을 진행.
+ */
+static bool gc_idle_step(struct ssd *ssd, int64_t now)
+{
+    struct gc_job *job = &ssd->gc_job;
+
+    if (!ssd->idle_gc_lines || now - ssd->last_req_ns < IDLE_GC_DELAY_NS ||
+        nand_idle_at(ssd) > now) {
+        return false;
+    }
+    if (!job->line) {
+        int prof = prof_enter(ssd, PROF_VICTIM);
+        struct line *victim_line = select_victim_line_empty(ssd);
+
+        prof_leave(ssd, prof);
+        if (victim_line) {
+            ssd->idle_erase_cnt++;
+        } else if (total_free_lines(ssd) <= ssd->sp.gc_thres_lines) {
+            /* background 기준까지는 force 기준 victim도 거둠 */
+            victim_line = select_victim_line(ssd, true);
+        } else if (total_free_lines(ssd) <=
+                   ssd->sp.gc_thres_lines + ssd->idle_gc_lines) {
+            victim_line = select_victim_line(ssd, false);
+        }
+        if (!victim_line) {
+            return false;
+        }
+        if (ssd->gc_verbose) {
+            ftl_log("[GC] %s: victim line=%d ipc=%d vpc=%d (idle)\n",
+                    pool_name(ssd, victim_line->cls),
+                    victim_line->id, victim_line->ipc, victim_line->vpc);
+        }
+        gc_job_start(ssd, job, victim_line, GC_EV_INCR | GC_EV_IDLE);
+        ssd->idle_gc_cnt++;
+    }
+    gc_job_step(ssd, job, ssd->sp.tt_luns);
+
+    return true;
+}
+
+/* background GC 한 step (요청 nreq개 분량): 진행 중인 victim이 없으면 새로 고름 */
+static bool gc_background_step(struct ssd *ssd, int nreq)
+{
+    struct gc_job *job = &ssd->gc_job;
+    int budget = gc_step_budget(ssd) * nreq;
+
+    /* pacing이 켜져 있으면 gc_thres_lines 아래는 쓰기 요청이 직접 진행 */
+    if (!budget || (ssd->gc_pace && total_free_lines(ssd) <= ssd->sp.gc_thres_lines)) {
+        return false;
+    }
+    if (!job->line) {
+        struct line *victim_line = select_victim_line(ssd, false);
+
+        if (!victim_line) {
+            return false;
+        }
+        if (ssd->gc_verbose) {
+            ftl_log("[GC] %s: victim line=%d ipc=%d vpc=%d (incremental)\n",
+                    pool_name(ssd, victim_line->cls),
+                    victim_line->id, victim_line->ipc, victim_line->vpc);
+        }
+        gc_job_start(ssd, job, victim_line, GC_EV_INCR);
+    }
+    gc_job_step(ssd, job, budget < ssd->sp.pgs_per_line ? budget : ssd->sp.pgs_per_line);
+
+    return true;
+}
+
+/* host 페이지 하나당 옮길 페이지 수 (fixed point, 정책은 ftl.h 참고) */
+static int64_t gc_pace_rate(struct ssd *ssd, struct line *victim_line)
+{
+    int64_t pgs = ssd->sp.pgs_per_line;
+    int64_t v = victim_line->vpc;
+    int64_t rate = (v << GC_PACE_SHIFT) / (pgs - v > 0 ? pgs - v : 1);
+    int free_lines = total_free_lines(ssd);
+    int start = ssd->sp.gc_thres_lines;
+    int full = ssd->sp.gc_thres_lines_high;
+
+    if (free_lines < start && free_lines > full) {
+        rate = rate * (start - full) / (free_lines - full);
+    }
+    return rate;
+}
+
+/*
+ * 쓰기 요청 하나(pages 페이지)의 GC 몫: free line이 gc_thres_lines 이하인 동안
+ * credit을 채우고, 쌓인 만큼 진행 중인 victim을 옮김. 옮긴 페이지 수를 반환.
+ */
+static int gc_pace_step(struct ssd *ssd, int pages)
+{
+    struct gc_job *job = &ssd->gc_job;
+    int64_t one = 1 << GC_PACE_SHIFT;
+    int64_t cap = (int64_t)GC_PACE_BURST_PAGES << GC_PACE_SHIFT;
+    int moved = 0;
+
+    if (total_free_lines(ssd) > ssd->sp.gc_thres_lines) {
+        ssd->gc_pace_credit = 0;
+        return 0;
+    }
+    while (total_free_lines(ssd) <= ssd->sp.gc_thres_lines) {
+        uint64_t moved0;
+        int64_t credit;
+        bool done;
+
+        if (!job->line) {
+            struct line *victim_line = select_victim_line(ssd, false);
+
+            if (!victim_line) {
+                break;
+            }
+            if (ssd->gc_verbose) {
+                ftl_log("[GC] %s: victim line=%d ipc=%d vpc=%d (paced)\n",
+                        pool_name(ssd, victim_line->cls),
+                        victim_line->id, victim_line->ipc, victim_line->vpc);
+            }
+            gc_job_start(ssd, job, victim_line, GC_EV_INCR);
+        }
+        if (pages) {
+            credit = ssd->gc_pace_credit + pages * gc_pace_rate(ssd, job->line);
+            ssd->gc_pace_credit = credit < cap ? credit : cap;
+            pages = 0;
+        }
+        if (ssd->gc_pace_credit < one) {
+            break;
+        }
+
+        /* victim을 다 비우면 (gc_job_finish는 job->moved를 그대로 둠) 남은 credit으로 다음 victim */
+        moved0 = job->moved;
+        done = gc_job_step(ssd, job, ssd->gc_pace_credit >> GC_PACE_SHIFT);
+        moved += job->moved - moved0;
+        ssd->gc_pace_credit -= (int64_t)(job->moved - moved0) << GC_PACE_SHIFT;
+        if (!done) {
+            break;
+        }
+    }
+    ssd->gc_pace_pages += moved;
+
+    return moved;
+}
+
+static inline bool line_is_free(struct line *line)
+{
+    return !line->open && line->ipc == 0 && line->vpc == 0;
+}
+
+/*
+ * Static wear leveling (정책은 ftl.h 참고). Y = 가장 덜 지워진 닫힌 라인,
+ * W = 가장 많이 지워진 free 라인. GC relocation은 WP를 거치므로 Y의 데이터를
+ * W에 직접 옮기지는 않고, Y를 비운 뒤 풀 소속만 맞바꿈.
+ */
+static bool wear_level_static(struct ssd *ssd)
+{
+    struct line_mgmt *lm = &ssd->lm;
+    struct line *y = NULL, *w = NULL;
+    uint64_t gc_writes0;
+
+    if (ssd->line_erases < ssd->wl_next_check) {
+        return false;
+    }
+    ssd->wl_next_check = ssd->line_erases + WL_CHECK_ERASES;
+
+    for (int i = 0; i < lm->tt_lines; i++) {
+        struct line *l = &lm->lines[i];
+
+        if (line_is_free(l)) {
+            if (!w || l->erase_cnt > w->erase_cnt) {
+                w = l;
+            }
+        } else if (!l->open && !l->gc) {
+            if (!y || l->erase_cnt < y->erase_cnt) {
+                y = l;
+            }
+        }
+    }
+    if (!y || !w || w->erase_cnt - y->erase_cnt < WL_STATIC_THRESHOLD) {
+        return false;
+    }
+
+    /* GC victim과 같은 상태로 만들고 (자료구조에서 뺌) 비움 */
+    if (y->victim) {
+        victim_remove(ssd, y);
+    } else if (y->ipc == 0) {
+        QTAILQ_REMOVE(&lm->full_line_list, y, entry);
+        lm->full_line_cnt--;
+    }
+
+    if (ssd->gc_verbose) {
+        ftl_log("[WL] %s line=%d erase=%d vpc=%d, most worn free line=%d erase=%d\n",
+                pool_name(ssd, y->cls),
+                y->id, y->erase_cnt, y->vpc, w->id, w->erase_cnt);
+    }
+
+    gc_writes0 = ssd->gc_writes;
+    do_gc_for_line(ssd, y, GC_EV_WL);
+    ssd->wl_writes += ssd->gc_writes - gc_writes0;
+    ssd->wl_moves++;
+
+    /* relocation 중에 W가 WP로 나갔을 수도 있음 */
+    if (line_is_free(w) && w->cls != y->cls) {
+        line_class_t wcls = w->cls;
+
+        QTAILQ_REMOVE(&lm->pool[wcls].free_list, w, entry);
+        QTAILQ_REMOVE(&lm->pool[y->cls].free_list, y, entry);
+        QTAILQ_INSERT_TAIL(&lm->pool[y->cls].free_list, w, entry);
+        QTAILQ_INSERT_TAIL(&lm->pool[wcls].free_list, y, entry);
+        w->cls = y->cls;
+        y->cls = wcls;
+    }
+
+    return true;
+}
+
+static uint64_t ssd_read(struct ssd *ssd, NvmeRequest *req)
+{
+    struct ssdparams *spp = &ssd->sp;
+    uint64_t lba = req->slba;
+    int nsecs = req->nlb;
+    struct ppa ppa;
+    uint64_t start_lpn = lba / spp->secs_per_pg;
+    uint64_t end_lpn = (lba + nsecs - 1) / spp->secs_per_pg;
+    uint64_t lpn;
+    uint64_t sublat, maxlat = 0;
+
+    if (start_lpn >= spp->tt_pgs) {
+    ftl_err("IO beyond device capacity: start_lpn=%"PRIu64", tt_pgs=%d\n",
+            start_lpn, spp->tt_pgs);
+    return 0;
+    }
+
+    if (end_lpn >= spp->tt_pgs) {
+        ftl_err("Clamping IO: start_lpn=%"PRIu64", end_lpn=%"PRIu64", tt_pgs=%d\n",
+                start_lpn, end_lpn, spp->tt_pgs);
+        end_lpn = spp->tt_pgs - 1;
+    }
+
+    /* normal IO read path */
+    for (lpn = start_lpn; lpn <= end_lpn; lpn++) {
+        ppa = get_maptbl_ent(ssd, lpn);
+        if (!mapped_ppa(&ppa) || !valid_ppa(ssd, &ppa)) {
             //printf("%s,lpn(%" PRId64 ") not mapped to valid ppa\n", ssd->ssdname, lpn);
             //printf("Invalid ppa,ch:%d,lun:%d,blk:%d,pl:%d,pg:%d,sec:%d\n",
             //ppa.g.ch, ppa.g.lun, ppa.g.blk, ppa.g.pl, ppa.g.pg, ppa.g.sec);
@@ -1345,6 +2482,7 @@ static uint64_t ssd_write(struct ssd *ssd, NvmeRequest *req)
     uint64_t lpn;
     uint64_t curlat = 0, maxlat = 0;
     int r;
+    int prof;
 
     
     if (start_lpn >= spp->tt_pgs) {
@@ -1359,25 +2497,39 @@ static uint64_t ssd_write(struct ssd *ssd, NvmeRequest *req)
         end_lpn = spp->tt_pgs - 1;
     }
 
+    if (ssd->gc_pace && gc_pace_step(ssd, end_lpn - start_lpn + 1)) {
+        ssd->req_gc_stalled = true;
+    }
     while (should_gc_high(ssd)) {
         /* perform GC here until !should_gc(ssd) */
-        r = do_gc(ssd, true);
-        if (r == -1)
-            break;
+        if (ssd->gc_job.line) {
+            /* 진행 중인 background GC부터 끝냄 (이미 일부 옮겨져 있어 가장 싸게 line이 나옴) */
+            gc_job_step(ssd, &ssd->gc_job, spp->pgs_per_line);
+        } else {
+            r = do_gc(ssd, true);
+            if (r == -1)
+                break;
+        }
+        ssd->gc_fg_stalls += !ssd->req_gc_stalled;
+        ssd->req_gc_stalled = true;
     }
 
     for (lpn = start_lpn; lpn <= end_lpn; lpn++) {
         /* ==== 논리 쓰기 시퀀스 증가 & decay 체크 ==== */
         ssd->host_writes++;                 // LPN 하나당 host write 1페이지
-        ftl_maybe_decay_lpn_stats(ssd);     // 필요하면 access_cnt decay
+        ftl_maybe_decay_lpn_stats(ssd);     // 필요하면 decay epoch 증가 (O(1))
+        ftl_maybe_tune_uid(ssd);            // UID_TUNE_PAGES마다 Hot 경계 재계산 (O(bins))
+        ftl_maybe_resize_pools(ssd);        // POOL_RESIZE_PAGES마다 pool 목표 크기 (O(lines))
 
         /* ==== LPN Hot/Cold 메타데이터 업데이트 ==== */
+        prof = prof_enter(ssd, PROF_CLASSIFY);
         ftl_update_lpn_on_write(ssd, lpn);
-        /*  - 여기서 lpn_state[lpn]이 HOT 또는 COLD로 정리됨
-         *  - 다음 단계에서 Hot/Cold 라인 풀로 라우팅할 때 사용할 수 있음
+        prof_leave(ssd, prof);
+        /*  - 여기서 lpn_stats[lpn].state가 온도 그룹으로 정리됨
+         *  - 다음 단계에서 그 그룹의 라인 풀로 라우팅
          */
 
-        bool is_hot = ftl_is_lpn_hot(ssd, lpn);
+        int cls = ftl_lpn_temp(ssd, lpn);
 
         /* ==== 기존 FTL 동작 (물리 페이지 할당/갱신) ==== */
         ppa = get_maptbl_ent(ssd, lpn);
@@ -1387,12 +2539,8 @@ static uint64_t ssd_write(struct ssd *ssd, NvmeRequest *req)
             set_rmap_ent(ssd, INVALID_LPN, &ppa);
         }
 
-        /* new write: Hot/Cold 전용 write pointer에서 페이지 할당 */
-        if (is_hot) {
-            ppa = get_new_page_hot(ssd);
-        } else {
-            ppa = get_new_page_cold(ssd);
-        }
+        /* new write: 온도 그룹 전용 write pointer에서 페이지 할당 */
+        ppa = get_new_page_from_wp(ssd, &ssd->wp_pool[cls]);
 
         /* update maptbl */
         set_maptbl_ent(ssd, lpn, &ppa);
@@ -1403,13 +2551,10 @@ static uint64_t ssd_write(struct ssd *ssd, NvmeRequest *req)
 
         /* NAND 쓰기 카운트 (host_writes는 위에서 이미 증가됨) */
         ssd->nand_writes++;
+        ssd->pool_host_writes[cls]++;
 
-        /* write pointer 진행: Hot/Cold에 따라 다른 포인터 */
-        if (is_hot) {
-            ssd_advance_write_pointer_hot(ssd);
-        } else {
-            ssd_advance_write_pointer_cold(ssd);
-        }
+        /* write pointer 진행: 온도 그룹마다 다른 포인터 */
+        ssd_advance_write_pointer_class(ssd, &ssd->wp_pool[cls], cls);
 
         struct nand_cmd swr;
         swr.type = USER_IO;
@@ -1506,6 +2651,90 @@ static uint64_t ssd_trim(struct ssd *ssd, NvmeRequest *req)
     return 0;  // Assume TRIM operations have no NAND latency
 }
 
+static inline int erase_hist_bin(int erase_cnt)
+{
+    int b = erase_cnt > 0 ? 64 - __builtin_clzll(erase_cnt) : 0;
+
+    return b < ERASE_HIST_BINS ? b : ERASE_HIST_BINS - 1;
+}
+
+/* cls < 0 이면 전체 라인 */
+static void line_erase_range(struct ssd *ssd, int cls, int *min, int *max,
+                             uint64_t *sum)
+{
+    struct line_mgmt *lm = &ssd->lm;
+    int n = 0;
+
+    *min = *max = 0;
+    *sum = 0;
+    for (int i = 0; i < lm->tt_lines; i++) {
+        struct line *l = &lm->lines[i];
+
+        if (cls >= 0 && l->cls != (line_class_t)cls) {
+            continue;
+        }
+        if (!n || l->erase_cnt < *min) {
+            *min = l->erase_cnt;
+        }
+        if (!n || l->erase_cnt > *max) {
+            *max = l->erase_cnt;
+        }
+        *sum += l->erase_cnt;
+        n++;
+    }
+}
+
+static void print_wear_summary(struct ssd *ssd)
+{
+    int min, max;
+    uint64_t sum;
+
+    line_erase_range(ssd, -1, &min, &max, &sum);
+    ftl_log("Line Erases:  min=%d avg=%.1f max=%d, static WL %lu lines (%lu pages)\n",
+            min, (double)sum / ssd->lm.tt_lines, max,
+            ssd->wl_moves, ssd->wl_writes);
+}
+
+void ftl_print_wear_stats(struct ssd *ssd)
+{
+    struct line_mgmt *lm = &ssd->lm;
+    uint64_t hist[ERASE_HIST_BINS] = { 0 };
+    int min, max, cnt;
+    uint64_t sum;
+    char rng[32];
+
+    for (int i = 0; i < lm->tt_lines; i++) {
+        hist[erase_hist_bin(lm->lines[i].erase_cnt)]++;
+    }
+
+    ftl_log("========== Line Wear ==========\n");
+    for (int c = hot_cls(ssd); c >= LINE_CLASS_COLD; c--) {
+        cnt = 0;
+        for (int i = 0; i < lm->tt_lines; i++) {
+            cnt += lm->lines[i].cls == (line_class_t)c;
+        }
+        line_erase_range(ssd, c, &min, &max, &sum);
+        ftl_log("%-4s %5d lines  erase min=%d avg=%.1f max=%d\n",
+                pool_name(ssd, c), cnt, min, cnt ? (double)sum / cnt : 0.0, max);
+    }
+    for (int b = 0; b < ERASE_HIST_BINS; b++) {
+        if (!hist[b]) {
+            continue;
+        }
+        if (b == 0) {
+            snprintf(rng, sizeof(rng), "0");
+        } else if (b == ERASE_HIST_BINS - 1) {
+            snprintf(rng, sizeof(rng), ">= %d", 1 << (b - 1));
+        } else {
+            snprintf(rng, sizeof(rng), "[%d, %d)", 1 << (b - 1), 1 << b);
+        }
+        ftl_log("  erase %-14s %6lu lines\n", rng, hist[b]);
+    }
+    ftl_log("static WL: %lu lines relocated, %lu pages\n",
+            ssd->wl_moves, ssd->wl_writes);
+    ftl_log("===============================\n");
+}
+
 void print_waf_stats(struct ssd *ssd)
 {
     struct ssdparams *spp = &ssd->sp;
@@ -1519,7 +2748,9 @@ void print_waf_stats(struct ssd *ssd)
     double nand_gib = 0.0;
     double gc_gib   = 0.0;
 
-    int free_total = ssd->lm.hot_free_line_cnt + ssd->lm.cold_free_line_cnt;
+    int free_total = total_free_lines(ssd);
+    char pools[256];
+    int len = 0;
 
     if (ssd->host_writes > 0) {
         waf = (double)ssd->nand_writes / (double)ssd->host_writes;
@@ -1539,122 +2770,1242 @@ void print_waf_stats(struct ssd *ssd)
             ssd->gc_writes, gc_gib);
     ftl_log("WAF:          %.4f\n", waf);
     ftl_log("GC Overhead:  %.2f%%\n", gc_overhead);
-    ftl_log("Free Lines:   %d / %d (%.1f%%) [hot=%d, cold=%d]\n",
+    for (int c = hot_cls(ssd); c >= LINE_CLASS_COLD; c--) {
+        len += snprintf(pools + len, sizeof(pools) - len, "%s%s=%d",
+                        c == hot_cls(ssd) ? "" : ", ", pool_name(ssd, c),
+                        ssd->lm.pool[c].free_cnt);
+    }
+    ftl_log("Free Lines:   %d / %d (%.1f%%) [%s]\n",
         free_total, ssd->lm.tt_lines,
-        (double)free_total / ssd->lm.tt_lines * 100.0,
-        ssd->lm.hot_free_line_cnt,
-        ssd->lm.cold_free_line_cnt);
+        (double)free_total / ssd->lm.tt_lines * 100.0, pools);
+    len = 0;
+    for (int c = hot_cls(ssd); c >= LINE_CLASS_COLD; c--) {
+        len += snprintf(pools + len, sizeof(pools) - len, "%s%s=%d/%d",
+                        c == hot_cls(ssd) ? "" : ", ", pool_name(ssd, c),
+                        ssd->lm.pool[c].lines, ssd->lm.pool[c].target);
+    }
+    ftl_log("Pool Lines:   %s (lines/target, resize %s, %lu lines moved)\n",
+            pools, ssd->pool_resize ? "on" : "off", ssd->pool_moves);
+    for (int c = hot_cls(ssd); c >= LINE_CLASS_COLD; c--) {
+        ftl_log("  %-5s host=%lu gc=%lu (%lu lines) WAF=%.3f\n",
+                pool_name(ssd, c), ssd->pool_host_writes[c],
+                ssd->pool_gc_writes[c], ssd->pool_gc_cnt[c],
+                ssd->pool_host_writes[c] ?
+                1.0 + (double)ssd->pool_gc_writes[c] / ssd->pool_host_writes[c] : 0.0);
+    }
+    len = 0;
+    for (int c = hot_cls(ssd); c > LINE_CLASS_COLD; c--) {
+        len += snprintf(pools + len, sizeof(pools) - len, "%s<=%lu ",
+                        pool_name(ssd, c), ssd->temp_bound[c]);
+    }
+    ftl_log("Temp Bounds:  %s(UID tune %s, %lu changes, decay window %lu)\n",
+            pools, ssd->uid_tune ? "on" : "off", ssd->uid_tunes,
+            ssd->hot_cold_decay_window);
+    print_wear_summary(ssd);
+    ftl_log("Idle GC:      %lu lines (%lu erase-only)\n",
+            ssd->idle_gc_cnt, ssd->idle_erase_cnt);
+    ftl_log("GC Pacing:    %s, %lu pages moved by writes, %lu foreground stalls\n",
+            ssd->gc_pace ? "on" : "off", ssd->gc_pace_pages, ssd->gc_fg_stalls);
+    if (ssd->gc_streams) {
+        len = 0;
+        for (int c = hot_cls(ssd); c >= LINE_CLASS_COLD; c--) {
+            len += snprintf(pools + len, sizeof(pools) - len,
+                            "%s%s young=%lu old=%lu", c == hot_cls(ssd) ? "" : " | ",
+                            pool_name(ssd, c), ssd->gc_stream_writes[c][0],
+                            ssd->gc_stream_writes[c][1]);
+        }
+        ftl_log("GC streams:   %s (age avg %lu)\n", pools, ssd->gc_age_avg);
+    }
+    print_ch_stats(ssd);
     ftl_log("====================================\n");
 }
 
-static inline int uid_interval_to_bin(uint64_t delta)
+static void io_stats_add(struct nand_io_stats *sum, const struct nand_io_stats *io)
 {
-    if (delta == 0 || delta == UINT64_MAX) {
-        return -1;  // 첫 write거나 비정상 값
+    for (int t = 0; t < 2; t++) {
+        for (int c = 0; c < 3; c++) {
+            sum->ops[t][c] += io->ops[t][c];
+        }
+        sum->busy_ns[t] += io->busy_ns[t];
+        sum->wait_ns[t] += io->wait_ns[t];
     }
+    sum->wait_gc_ns += io->wait_gc_ns;
+}
 
-    int b = 0;
-    while (delta > 1 && b < UID_HIST_BINS - 1) {
-        delta >>= 1;
-        b++;
-    }
-    return b;
+static inline uint64_t io_stats_ops(const struct nand_io_stats *io, int type)
+{
+    return io->ops[type][NAND_READ] + io->ops[type][NAND_WRITE] +
+           io->ops[type][NAND_ERASE];
 }
 
-/* 한 번의 host write가 발생할 때 LPN별 통계/UID 히스토그램 업데이트 */
-void ftl_maybe_decay_lpn_stats(struct ssd *ssd)
+/*
+ * 통계 구간의 끝: 밀린 명령(next_lun_avail_time > now)도 busy에 이미 들어가 있으므로
+ * 가장 늦게 비는 LUN까지를 구간으로 잡아야 이용률이 100%를 넘지 않음
+ */
+static int64_t io_stats_end(struct ssd *ssd, int64_t now)
 {
-    if (ssd->host_writes - ssd->hot_cold_last_decay_seq <
-        HOT_DECAY_WINDOW_PAGES) {
-        return;
-    }
+    int64_t end = now;
 
-    struct ssdparams *spp = &ssd->sp;
-    for (int i = 0; i < spp->tt_pgs; i++) {
-        /* 접근 횟수는 절반으로 줄이기 (0으로 가도록) */
-        ssd->lpn_access_cnt[i] >>= 1;
+    for (int i = 0; i < ssd->sp.tt_luns; i++) {
+        int64_t t = ssd->lun[i].next_lun_avail_time;
 
-        /* 짧은 interval 연속 카운트도 서서히 줄이기 */
-        if (ssd->lpn_short_int_cnt[i] > 0) {
-            ssd->lpn_short_int_cnt[i] >>= 1;
-        }
+        end = t > end ? t : end;
     }
-
-    ssd->hot_cold_last_decay_seq = ssd->host_writes;
+    return end;
 }
 
-static inline void update_lpn_stats_on_write(struct ssd *ssd, uint64_t lpn)
+/* "util"은 busy / (io_stats_t0 ~ io_stats_end 구간 × LUN 수) */
+static void print_io_line(const char *name, const struct nand_io_stats *io,
+                          double span_ns)
 {
-    uint64_t seq  = ssd->host_writes;              // 현재 host write 시퀀스
-    uint64_t last = ssd->lpn_last_write_seq[lpn];
-    uint64_t delta = (last == 0) ? UINT64_MAX : (seq - last);
+    uint64_t uops = io_stats_ops(io, USER_IO);
+    uint64_t gops = io_stats_ops(io, GC_IO);
 
-    /* UID 히스토그램: update interval 분포 분석용 (연구/디버깅 용도) */
-    if (delta != UINT64_MAX) {
-        int bin = uid_interval_to_bin(delta);
-        if (bin >= 0) {
-            ssd->uid_hist[bin]++;
+    ftl_log("%-6s util user=%5.1f%% gc=%5.1f%% | ops user r/w=%lu/%lu "
+            "gc r/w/e=%lu/%lu/%lu | wait user=%.1fus (gc %.0f%%) gc=%.1fus\n",
+            name,
+            span_ns > 0 ? 100.0 * io->busy_ns[USER_IO] / span_ns : 0.0,
+            span_ns > 0 ? 100.0 * io->busy_ns[GC_IO] / span_ns : 0.0,
+            io->ops[USER_IO][NAND_READ], io->ops[USER_IO][NAND_WRITE],
+            io->ops[GC_IO][NAND_READ], io->ops[GC_IO][NAND_WRITE],
+            io->ops[GC_IO][NAND_ERASE],
+            uops ? io->wait_ns[USER_IO] / 1e3 / uops : 0.0,
+            io->wait_ns[USER_IO] ? 100.0 * io->wait_gc_ns / io->wait_ns[USER_IO] : 0.0,
+            gops ? io->wait_ns[GC_IO] / 1e3 / gops : 0.0);
+}
+
+/*
+ * 채널 타이밍은 모델링하지 않으므로 (ssd_advance_status의 #if 0) 채널 통계는
+ * 채널에 속한 LUN 합계; 채널 간 차이는 write pointer가 LUN을 얼마나 고르게 쓰는지를 보여줌
+ */
+static void print_ch_stats(struct ssd *ssd)
+{
+    struct ssdparams *spp = &ssd->sp;
+    double elapsed = io_stats_end(ssd, qemu_clock_get_ns(QEMU_CLOCK_REALTIME)) -
+                     ssd->io_stats_t0;
+    struct nand_io_stats all;
+    double umin = -1, umax = 0;
+    int lmin = 0, lmax = 0;
+    char name[32];
+
+    memset(&all, 0, sizeof(all));
+    ftl_log("NAND I/O (%.3f s, %d ch x %d lun):\n", elapsed / 1e9, spp->nchs,
+            spp->luns_per_ch);
+    for (int ch = 0; ch < spp->nchs; ch++) {
+        struct nand_io_stats sum;
+
+        memset(&sum, 0, sizeof(sum));
+        for (int lun = 0; lun < spp->luns_per_ch; lun++) {
+            int i = ch * spp->luns_per_ch + lun;
+            struct nand_io_stats *io = &ssd->lun[i].io;
+            double u = io->busy_ns[USER_IO] + io->busy_ns[GC_IO];
+
+            io_stats_add(&sum, io);
+            if (umin < 0 || u < umin) {
+                umin = u;
+                lmin = i;
+            }
+            if (u > umax) {
+                umax = u;
+                lmax = i;
+            }
         }
+        io_stats_add(&all, &sum);
+        snprintf(name, sizeof(name), "ch%d", ch);
+        print_io_line(name, &sum, elapsed * spp->luns_per_ch);
     }
-
-    /* 접근 횟수 증가 (최근 window 기준) */
-    if (ssd->lpn_access_cnt[lpn] < UINT32_MAX) {
-        ssd->lpn_access_cnt[lpn]++;
+    print_io_line("total", &all, elapsed * spp->tt_luns);
+    if (elapsed > 0) {
+        ftl_log("LUN util: min=%.1f%% (lun %d) avg=%.1f%% max=%.1f%% (lun %d)\n",
+                100.0 * umin / elapsed, lmin,
+                100.0 * (all.busy_ns[USER_IO] + all.busy_ns[GC_IO]) /
+                    (elapsed * spp->tt_luns),
+                100.0 * umax / elapsed, lmax);
     }
+}
 
-    /* 짧은 interval(= 자주 덮어씀)이면 연속 카운트↑, 아니면 리셋 */
-    if (delta <= HOT_INTERVAL_THRESHOLD_PAGES) {
-        if (ssd->lpn_short_int_cnt[lpn] < 255) {
-            ssd->lpn_short_int_cnt[lpn]++;
-        }
-    } else {
-        ssd->lpn_short_int_cnt[lpn] = 0;
+void ftl_print_lun_stats(struct ssd *ssd)
+{
+    struct ssdparams *spp = &ssd->sp;
+    double elapsed = io_stats_end(ssd, qemu_clock_get_ns(QEMU_CLOCK_REALTIME)) -
+                     ssd->io_stats_t0;
+    char name[32];
+
+    ftl_log("========== LUN I/O (%.3f s) ==========\n", elapsed / 1e9);
+    for (int i = 0; i < spp->tt_luns; i++) {
+        snprintf(name, sizeof(name), "%d/%d", i / spp->luns_per_ch,
+                 i % spp->luns_per_ch);
+        print_io_line(name, &ssd->lun[i].io, elapsed);
     }
+    ftl_log("======================================\n");
+}
 
-    /* 마지막 쓰기 시점 갱신 */
-    ssd->lpn_last_write_seq[lpn] = seq;
+void ftl_reset_io_stats(struct ssd *ssd)
+{
+    for (int i = 0; i < ssd->sp.tt_luns; i++) {
+        memset(&ssd->lun[i].io, 0, sizeof(ssd->lun[i].io));
+    }
+    ssd->io_stats_t0 = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
+}
 
-    /* ==== Hot/Cold 상태 전이 ==== */
-    lpn_state_t st = ssd->lpn_state[lpn];
+static inline int uid_interval_to_bin(uint64_t delta)
+{
+    if (delta == 0 || delta == UINT64_MAX) {
+        return -1;  // 첫 write거나 비정상 값
+    }
 
-    if (st == LPN_STATE_COLD) {
-        /* 많이 쓰이고, 짧은 간격 패턴이 여러 번 나온 애는 Hot로 승격 */
-        if (ssd->lpn_access_cnt[lpn] >= HOT_ACCESS_THRESHOLD &&
-            ssd->lpn_short_int_cnt[lpn] >= HOT_INTERVAL_CONFIRM_COUNT) {
-            ssd->lpn_state[lpn] = LPN_STATE_HOT;
-        }
-    } else { /* 현재 HOT인 LPN */
-        /*
-         * 1) 최근 window에서 access_cnt가 충분히 크지 않거나
-         * 2) 너무 오랫동안 안 쓰였으면 (delta가 매우 큼)
-         *    → 식었다고 보고 Cold로 강등
-         */
-        if (ssd->lpn_access_cnt[lpn] < HOT_ACCESS_THRESHOLD ||
-            delta > HOT_INTERVAL_THRESHOLD_PAGES * 4) {
-            ssd->lpn_state[lpn] = LPN_STATE_COLD;
-            ssd->lpn_short_int_cnt[lpn] = 0;
-        }
+    int b = 0;
+    while (delta > 1 && b < UID_HIST_BINS - 1) {
+        delta >>= 1;
+        b++;
     }
+    return b;
 }
 
-/* 외부에서 쓰기 편하게 wrapper 함수 제공 (ftl.h에 프로토타입 있다고 가정) */
-bool ftl_is_lpn_hot(struct ssd *ssd, uint64_t lpn)
+/*
+ * 온도 그룹 경계: Hot은 hot, 중간 그룹은 tt_pgs 기준 band지만 Hot 경계보다
+ * 적어도 2^TEMP_BAND_SHIFT 배씩은 넓게
+ */
+static void ftl_set_temp_bounds(struct ssd *ssd, uint64_t hot)
 {
-    return ssd->lpn_state[lpn] == LPN_STATE_HOT;
+    int h = ssd->nr_temps - 1;
+
+    ssd->temp_bound[LINE_CLASS_COLD] = UINT64_MAX;
+    for (int t = 1; t < h; t++) {
+        uint64_t band = (uint64_t)ssd->sp.tt_pgs >> (TEMP_BAND_SHIFT * (t - 1));
+        uint64_t lo = hot << (TEMP_BAND_SHIFT * (h - t));
+
+        ssd->temp_bound[t] = band > lo ? band : lo;
+    }
+    ssd->temp_bound[h] = hot;
 }
 
-void ftl_update_lpn_on_write(struct ssd *ssd, uint64_t lpn)
+/*
+ * decay window 변경: epoch을 새 window 기준 (host_writes / window)으로 다시 맞춤.
+ * lpn_apply_decay()는 LPN의 마지막 쓰기 시점도 같은 window로 나누므로 shift는
+ * 음수가 되지 않고, 바뀌기 전에 쓰인 LPN은 새 window 기준으로 decay됨
+ */
+static void ftl_set_decay_window(struct ssd *ssd, uint64_t window)
 {
-    update_lpn_stats_on_write(ssd, lpn);
+    window = window ? window : 1;
+    if (window == ssd->hot_cold_decay_window) {
+        return;
+    }
+    ssd->hot_cold_decay_window = window;
+    ssd->hot_cold_decay_epoch = ssd->host_writes / window;
+    ssd->hot_cold_last_decay_seq = ssd->hot_cold_decay_epoch * window;
 }
 
-static void *ftl_thread(void *arg)
+/* 최근 UID 분포의 knee로 Hot 경계 계산 (ftl.h의 UID tuner 설명 참고) */
+static void uid_tune(struct ssd *ssd)
 {
-    FemuCtrl *n = (FemuCtrl *)arg;
-    struct ssd *ssd = n->ssd;
-    NvmeRequest *req = NULL;
+    uint64_t hot = HOT_INTERVAL_THRESHOLD_PAGES;
+    uint64_t n = 0, cum = 0;
+    double sum = 0.0, mean;
+
+    for (int b = 0; b < (int)UID_HIST_BINS; b++) {
+        ssd->uid_win[b] = ssd->uid_win[b] / 2 + (ssd->uid_hist[b] - ssd->uid_prev[b]);
+        ssd->uid_prev[b] = ssd->uid_hist[b];
+        n += ssd->uid_win[b];
+        sum += (double)ssd->uid_win[b] * (3ULL << b) / 2;   /* bin 중간값 1.5 * 2^b */
+    }
+    if (n < UID_TUNE_MIN_SAMPLES) {
+        return;
+    }
+    mean = sum / n;
+
+    for (int b = 0; b < (int)UID_HIST_BINS - 1; b++) {
+        uint64_t lim = 2ULL << b;
+        double x = lim / mean, ref, foot = 0.0;
+
+        /* x >= 1 이면 기준 분포가 이미 63% 이상이라 UID_TUNE_RATIO(2)배는 불가능 */
+        if (x >= 1.0) {
+            break;
+        }
+        cum += ssd->uid_win[b];
+        ref = x * (1 - x / 2 * (1 - x / 3 * (1 - x / 4)));     /* 1 - e^-x */
+        if (cum < UID_TUNE_RATIO * ref * n || lim <= hot) {
+            continue;
+        }
+        /* Little's law: 강등 전까지 Hot으로 남는 interval의 (비율 × 길이) 합 = Hot LPN 수 */
+        for (int k = 0; k < (int)UID_HIST_BINS && (2ULL << k) <= lim * HOT_DEMOTE_FACTOR; k++) {
+            foot += (double)ssd->uid_win[k] / n * (3ULL << k) / 2;
+        }
+        if (foot > (double)ssd->sp.tt_pgs * HOT_POOL_PCT / 100 * UID_TUNE_HOT_FILL_PCT / 100) {
+            break;
+        }
+        hot = lim;
+    }
+
+    if (hot != ssd->temp_bound[hot_cls(ssd)]) {
+        uint64_t window = (uint64_t)HOT_DECAY_WINDOW_PAGES;
+
+        ftl_log("[UID] Hot interval threshold %lu -> %lu pages (mean interval %.0f)\n",
+                ssd->temp_bound[hot_cls(ssd)], hot, mean);
+        ftl_set_temp_bounds(ssd, hot);
+        ftl_set_decay_window(ssd, hot * HOT_DECAY_MIN_INTERVALS > window ?
+                                  hot * HOT_DECAY_MIN_INTERVALS : window);
+        ssd->uid_tunes++;
+    }
+}
+
+void ftl_maybe_tune_uid(struct ssd *ssd)
+{
+    if (!ssd->uid_tune || ssd->host_writes < ssd->uid_tune_next) {
+        return;
+    }
+    ssd->uid_tune_next = ssd->host_writes + (UID_TUNE_PAGES ? UID_TUNE_PAGES : 1);
+    uid_tune(ssd);
+}
+
+/*
+ * host write 1페이지마다 호출: window를 넘겼으면 decay epoch만 올림.
+ * 예전처럼 tt_pgs 전체를 절반으로 줄이는 sweep은 하지 않고,
+ * 각 LPN은 다음 쓰기 때 lpn_apply_decay()에서 밀린 만큼 한 번에 shift.
+ */
+void ftl_maybe_decay_lpn_stats(struct ssd *ssd)
+{
+    if (ssd->host_writes - ssd->hot_cold_last_decay_seq <
+        ssd->hot_cold_decay_window) {
+        return;
+    }
+
+    ssd->hot_cold_decay_epoch++;
+    ssd->hot_cold_last_decay_seq = ssd->host_writes;
+}
+
+/* 마지막 쓰기 이후 지나간 decay epoch 수만큼 access_cnt / short_int 를 절반씩 */
+static inline void lpn_apply_decay(struct ssd *ssd, struct lpn_stat *st,
+                                   uint64_t last)
+{
+    uint64_t lpn_epoch = last / ssd->hot_cold_decay_window;
+    uint64_t shift = ssd->hot_cold_decay_epoch - lpn_epoch;
+
+    if (shift == 0) {
+        return;
+    }
+
+    /* 접근 횟수는 절반으로 줄이기 (0으로 가도록) */
+    st->access_cnt = (shift >= LPN_CNT_BITS) ? 0 : (st->access_cnt >> shift);
+
+    /* 짧은 interval 연속 카운트도 서서히 줄이기 */
+    st->short_int = (shift >= LPN_SHORT_BITS) ? 0 : (st->short_int >> shift);
+}
+
+/*
+ * Hot 아래 그룹 중 update interval이 들어가는 band: temp_bound[t] 이하인 가장 뜨거운 t.
+ * nr_temps == 2 이면 항상 Cold.
+ */
+static inline int lpn_interval_band(struct ssd *ssd, uint64_t delta)
+{
+    int t = LINE_CLASS_COLD;
+
+    while (t + 1 < hot_cls(ssd) && delta <= ssd->temp_bound[t + 1]) {
+        t++;
+    }
+    return t;
+}
+
+/* 한 번의 host write가 발생할 때 LPN별 통계/UID 히스토그램 업데이트 */
+static inline void update_lpn_stats_on_write(struct ssd *ssd, uint64_t lpn)
+{
+    /* 레코드를 한 번 읽어 로컬에서 갱신한 뒤 한 번에 씀 */
+    struct lpn_stat st = ssd->lpn_stats[lpn];
+    uint64_t hot_int = ssd->temp_bound[hot_cls(ssd)];  // Hot 경계 (UID tuner)
+    uint64_t seq  = ssd->host_writes;              // 현재 host write 시퀀스
+    uint64_t delta = (st.last_seq == 0) ? UINT64_MAX :
+                     ((seq - st.last_seq) & LPN_SEQ_MASK);
+
+    /* 밀려 있던 decay를 먼저 반영 (처음 쓰는 LPN은 카운트가 전부 0) */
+    if (delta != UINT64_MAX) {
+        lpn_apply_decay(ssd, &st, seq - delta);
+    }
+
+    /* UID 히스토그램: update interval 분포 분석용 (연구/디버깅 용도) */
+    if (delta != UINT64_MAX) {
+        int bin = uid_interval_to_bin(delta);
+        if (bin >= 0) {
+            ssd->uid_hist[bin]++;
+        }
+    }
+
+    /* 접근 횟수 증가 (최근 window 기준) */
+    if (st.access_cnt < LPN_CNT_MAX) {
+        st.access_cnt++;
+    }
+
+    /* 짧은 interval(= 자주 덮어씀)이면 연속 카운트↑, 아니면 리셋 */
+    if (delta <= hot_int) {
+        if (st.short_int < LPN_SHORT_MAX) {
+            st.short_int++;
+        }
+    } else {
+        st.short_int = 0;
+    }
+
+    /* 마지막 쓰기 시점 갱신 */
+    st.last_seq = seq & LPN_SEQ_MASK;
+
+    /* ==== 온도 그룹 전이 ==== */
+    if (st.state != hot_cls(ssd)) {
+        /* 많이 쓰이고, 짧은 간격 패턴이 여러 번 나온 애는 Hot로 승격 */
+        if (st.access_cnt >= HOT_ACCESS_THRESHOLD &&
+            st.short_int >= HOT_INTERVAL_CONFIRM_COUNT) {
+            st.state = hot_cls(ssd);
+        } else {
+            /* 아니면 interval band 쪽으로 한 그룹씩 */
+            int band = lpn_interval_band(ssd, delta);
+            int t = st.state;
+
+            st.state = band > t ? t + 1 : band < t ? t - 1 : t;
+        }
+    } else { /* 현재 HOT인 LPN */
+        /*
+         * 1) 최근 window에서 access_cnt가 충분히 크지 않거나
+         * 2) 너무 오랫동안 안 쓰였으면 (delta가 매우 큼)
+         *    → 식었다고 보고 interval band의 그룹으로 강등
+         */
+        if (st.access_cnt < HOT_ACCESS_THRESHOLD ||
+            delta > hot_int * HOT_DEMOTE_FACTOR) {
+            st.state = lpn_interval_band(ssd, delta);
+            st.short_int = 0;
+        }
+    }
+
+    ssd->lpn_stats[lpn] = st;
+}
+
+/* 외부에서 쓰기 편하게 wrapper 함수 제공 (ftl.h에 프로토타입 있다고 가정) */
+bool ftl_is_lpn_hot(struct ssd *ssd, uint64_t lpn)
+{
+    return ssd->lpn_stats[lpn].state == hot_cls(ssd);
+}
+
+int ftl_lpn_temp(struct ssd *ssd, uint64_t lpn)
+{
+    return ssd->lpn_stats[lpn].state;
+}
+
+void ftl_update_lpn_on_write(struct ssd *ssd, uint64_t lpn)
+{
+    update_lpn_stats_on_write(ssd, lpn);
+}
+
+/* ===== I/O trace 기록 (포맷은 ftl.h 참고) ===== */
+
+static inline uint8_t *trace_put_varint(uint8_t *p, uint64_t v)
+{
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static inline uint8_t *trace_put_zigzag(uint8_t *p, int64_t v)
+{
+    return trace_put_varint(p, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+static void *ftl_trace_writer(void *arg)
+{
+    struct ftl_trace *tr = arg;
+
+    while (1) {
+        uint64_t head = __atomic_load_n(&tr->head, __ATOMIC_ACQUIRE);
+        uint64_t tail = tr->tail;
+
+        if (tail == head) {
+            if (__atomic_load_n(&tr->stop, __ATOMIC_ACQUIRE) &&
+                __atomic_load_n(&tr->head, __ATOMIC_ACQUIRE) == tail) {
+                break;
+            }
+            usleep(1000);
+            continue;
+        }
+
+        int b = tail % FTL_TRACE_NR_BUFS;
+        if (fwrite(tr->buf[b], 1, tr->len[b], tr->fp) != tr->len[b]) {
+            ftl_err("trace: write failed, recording stopped\n");
+            __atomic_store_n(&tr->failed, true, __ATOMIC_RELEASE);
+            break;
+        }
+        __atomic_store_n(&tr->tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    fflush(tr->fp);
+    return NULL;
+}
+
+static void ftl_trace_open(struct ssd *ssd, const char *path)
+{
+    struct ftl_trace *tr;
+    uint8_t hdr[FTL_TRACE_HDR_SZ];
+    uint32_t ver = FTL_TRACE_VERSION;
+    uint32_t spg = ssd->sp.secs_per_pg;
+    FILE *fp = fopen(path, "wb");
+
+    if (!fp) {
+        ftl_err("trace: cannot open %s, recording disabled\n", path);
+        return;
+    }
+
+    memcpy(hdr, FTL_TRACE_MAGIC, 8);
+    memcpy(hdr + 8, &ver, 4);
+    memcpy(hdr + 12, &spg, 4);
+    fwrite(hdr, 1, sizeof(hdr), fp);
+
+    tr = g_malloc0(sizeof(struct ftl_trace));
+    tr->fp = fp;
+    for (int i = 0; i < FTL_TRACE_NR_BUFS; i++) {
+        tr->buf[i] = g_malloc(FTL_TRACE_BUF_SZ);
+    }
+    ssd->trace = tr;
+
+    qemu_thread_create(&tr->writer, "FEMU-FTL-Trace", ftl_trace_writer, tr,
+                       QEMU_THREAD_JOINABLE);
+    ftl_log("trace: recording requests to %s\n", path);
+}
+
+/* 현재 버퍼를 writer에 넘김; 빈 버퍼가 없으면 false */
+static bool ftl_trace_seal(struct ftl_trace *tr)
+{
+    uint64_t tail = __atomic_load_n(&tr->tail, __ATOMIC_ACQUIRE);
+
+    if (tr->head + 1 - tail >= FTL_TRACE_NR_BUFS) {
+        return false;
+    }
+
+    tr->len[tr->head % FTL_TRACE_NR_BUFS] = tr->pos;
+    tr->recs[tr->head % FTL_TRACE_NR_BUFS] = tr->pos_recs;
+    __atomic_store_n(&tr->head, tr->head + 1, __ATOMIC_RELEASE);
+    tr->pos = 0;
+    tr->pos_recs = 0;
+    return true;
+}
+
+static void ftl_trace_record(struct ssd *ssd, NvmeRequest *req, int poller)
+{
+    struct ftl_trace *tr = ssd->trace;
+    uint32_t nr = 0;
+    uint32_t need;
+    uint8_t *p;
+    int op;
+
+    switch (req->cmd.opcode) {
+    case NVME_CMD_WRITE:
+        op = FTL_TRACE_OP_WRITE;
+        break;
+    case NVME_CMD_READ:
+        op = FTL_TRACE_OP_READ;
+        break;
+    case NVME_CMD_DSM:
+        op = FTL_TRACE_OP_DSM;
+        nr = req->dsm_ranges ? req->dsm_nr_ranges : 0;
+        break;
+    default:
+        return;
+    }
+
+    /* writer가 멈췄으면 버퍼가 다시 비지 않으므로 채우지 않고 버림 */
+    if (__atomic_load_n(&tr->failed, __ATOMIC_ACQUIRE)) {
+        tr->nr_dropped++;
+        return;
+    }
+
+    /* record 최대 크기: tag + varint 4개 + range당 varint 2개 */
+    need = 1 + 4 * FTL_TRACE_MAX_VARINT + nr * 2 * FTL_TRACE_MAX_VARINT;
+    if (need > FTL_TRACE_BUF_SZ) {
+        tr->nr_dropped++;
+        return;
+    }
+    if ((tr->pos + need > FTL_TRACE_BUF_SZ ||
+         (tr->pos && req->stime - tr->seal_stime >= FTL_TRACE_FLUSH_NS)) &&
+        ftl_trace_seal(tr)) {
+        tr->seal_stime = req->stime;
+    }
+    if (tr->pos + need > FTL_TRACE_BUF_SZ) {
+        tr->nr_dropped++;
+        return;
+    }
+
+    p = tr->buf[tr->head % FTL_TRACE_NR_BUFS] + tr->pos;
+    if (poller < FTL_TRACE_POLLER_ESC) {
+        *p++ = op | (poller << 2);
+    } else {
+        *p++ = op | (FTL_TRACE_POLLER_ESC << 2);
+        p = trace_put_varint(p, poller);
+    }
+    p = trace_put_zigzag(p, req->stime - tr->prev_stime);
+    tr->prev_stime = req->stime;
+
+    if (op == FTL_TRACE_OP_DSM) {
+        p = trace_put_varint(p, nr);
+        p = trace_put_varint(p, req->dsm_attributes);
+        for (uint32_t i = 0; i < nr; i++) {
+            uint64_t slba = le64_to_cpu(req->dsm_ranges[i].slba);
+            uint32_t nlb = le32_to_cpu(req->dsm_ranges[i].nlb);
+
+            p = trace_put_zigzag(p, (int64_t)(slba - tr->prev_lba));
+            p = trace_put_varint(p, nlb);
+            tr->prev_lba = slba + nlb;
+        }
+    } else {
+        p = trace_put_zigzag(p, (int64_t)(req->slba - tr->prev_lba));
+        p = trace_put_varint(p, req->nlb);
+        tr->prev_lba = req->slba + req->nlb;
+    }
+
+    tr->pos = p - tr->buf[tr->head % FTL_TRACE_NR_BUFS];
+    tr->pos_recs++;
+    tr->nr_records++;
+}
+
+void ftl_trace_close(struct ssd *ssd)
+{
+    struct ftl_trace *tr = ssd->trace;
+
+    if (!tr) {
+        return;
+    }
+
+    /* 마지막 버퍼는 writer가 따라올 때까지 기다렸다가 넘김 (writer가 멈췄으면 기다리지 않음) */
+    while (tr->pos && !__atomic_load_n(&tr->failed, __ATOMIC_ACQUIRE) &&
+           !ftl_trace_seal(tr)) {
+        usleep(1000);
+    }
+    __atomic_store_n(&tr->stop, true, __ATOMIC_RELEASE);
+    qemu_thread_join(&tr->writer);
+
+    if (tr->failed) {
+        /* 파일에 못 쓴 record: 못 넘긴 현재 버퍼 + writer가 남긴 버퍼들 */
+        uint64_t lost = tr->pos_recs;
+
+        for (uint64_t i = tr->tail; i < tr->head; i++) {
+            lost += tr->recs[i % FTL_TRACE_NR_BUFS];
+        }
+        tr->nr_records -= lost;
+        tr->nr_dropped += lost;
+        ftl_err("trace: %lu recorded requests lost after write failure\n", lost);
+    }
+    ftl_log("trace: %lu requests recorded, %lu dropped\n",
+            tr->nr_records, tr->nr_dropped);
+
+    fclose(tr->fp);
+    for (int i = 0; i < FTL_TRACE_NR_BUFS; i++) {
+        g_free(tr->buf[i]);
+    }
+    g_free(tr);
+    ssd->trace = NULL;
+}
+
+/* ===== GC event log (포맷은 ftl.h 참고) ===== */
+
+static void *ftl_gclog_drain(void *arg)
+{
+    struct ftl_gclog *gl = arg;
+
+#ifdef SCHED_IDLE
+    /* FTL 스레드와 CPU를 다투지 않도록 가장 낮은 우선순위로 */
+    struct sched_param sp = { .sched_priority = 0 };
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &sp);
+#endif
+
+    while (1) {
+        bool stop = __atomic_load_n(&gl->stop, __ATOMIC_ACQUIRE);
+        uint64_t head = __atomic_load_n(&gl->head, __ATOMIC_ACQUIRE);
+        uint64_t tail = gl->tail;
+
+        if (tail == head) {
+            if (stop) {
+                break;
+            }
+            usleep(FTL_GCLOG_DRAIN_US);
+            continue;
+        }
+
+        /* ring 끝에서 잘리지 않는 연속 구간만 한 번에 */
+        uint64_t idx = tail % FTL_GCLOG_RING_SZ;
+        uint64_t n = head - tail;
+        if (n > FTL_GCLOG_RING_SZ - idx) {
+            n = FTL_GCLOG_RING_SZ - idx;
+        }
+        if (fwrite(&gl->ring[idx], sizeof(struct gc_event), n, gl->fp) != n) {
+            ftl_err("gclog: write failed, recording stopped\n");
+            break;
+        }
+        __atomic_store_n(&gl->tail, tail + n, __ATOMIC_RELEASE);
+        if (tail + n == head) {
+            fflush(gl->fp);
+        }
+    }
+
+    fflush(gl->fp);
+    return NULL;
+}
+
+static void ftl_gclog_open(struct ssd *ssd, const char *path)
+{
+    struct ftl_gclog *gl;
+    uint8_t hdr[FTL_GCLOG_HDR_SZ];
+    uint32_t ver = FTL_GCLOG_VERSION;
+    uint32_t rec_sz = sizeof(struct gc_event);
+    FILE *fp = fopen(path, "wb");
+
+    if (!fp) {
+        ftl_err("gclog: cannot open %s, recording disabled\n", path);
+        return;
+    }
+
+    memcpy(hdr, FTL_GCLOG_MAGIC, 8);
+    memcpy(hdr + 8, &ver, 4);
+    memcpy(hdr + 12, &rec_sz, 4);
+    fwrite(hdr, 1, sizeof(hdr), fp);
+
+    gl = g_malloc0(sizeof(struct ftl_gclog));
+    gl->fp = fp;
+    ssd->gclog = gl;
+
+    qemu_thread_create(&gl->drainer, "FEMU-FTL-GCLog", ftl_gclog_drain, gl,
+                       QEMU_THREAD_JOINABLE);
+    ftl_log("gclog: recording GC events to %s\n", path);
+}
+
+static void ftl_gclog_record(struct ssd *ssd, const struct gc_event *ev)
+{
+    struct ftl_gclog *gl = ssd->gclog;
+    uint64_t tail = __atomic_load_n(&gl->tail, __ATOMIC_ACQUIRE);
+
+    if (gl->head - tail >= FTL_GCLOG_RING_SZ) {
+        gl->nr_dropped++;
+        return;
+    }
+    gl->ring[gl->head % FTL_GCLOG_RING_SZ] = *ev;
+    __atomic_store_n(&gl->head, gl->head + 1, __ATOMIC_RELEASE);
+}
+
+void ftl_gclog_close(struct ssd *ssd)
+{
+    struct ftl_gclog *gl = ssd->gclog;
+
+    if (!gl) {
+        return;
+    }
+
+    __atomic_store_n(&gl->stop, true, __ATOMIC_RELEASE);
+    qemu_thread_join(&gl->drainer);
+
+    ftl_log("gclog: %lu GC events recorded, %lu dropped\n",
+            gl->head, gl->nr_dropped);
+
+    fclose(gl->fp);
+    g_free(gl);
+    ssd->gclog = NULL;
+}
+
+/* ===== 공유 메모리 통계 페이지 (레이아웃은 ftl.h 참고) ===== */
+
+static void ftl_stats_open(struct ssd *ssd, const char *path)
+{
+    struct ftl_stats_page *pg;
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0) {
+        ftl_err("stats: cannot open %s, disabled\n", path);
+        return;
+    }
+    if (ftruncate(fd, sizeof(struct ftl_stats_page)) != 0) {
+        ftl_err("stats: cannot size %s, disabled\n", path);
+        close(fd);
+        return;
+    }
+    pg = mmap(NULL, sizeof(struct ftl_stats_page), PROT_READ | PROT_WRITE,
+              MAP_SHARED, fd, 0);
+    close(fd);
+    if (pg == MAP_FAILED) {
+        ftl_err("stats: cannot mmap %s, disabled\n", path);
+        return;
+    }
+
+    /* magic은 마지막에: reader가 덜 초기화된 페이지를 보지 않도록 */
+    pg->version = FTL_STATS_VERSION;
+    pg->size = sizeof(struct ftl_stats_page);
+    pg->tt_lines = ssd->lm.tt_lines;
+    pg->tt_luns = ssd->sp.tt_luns;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(pg->magic, FTL_STATS_MAGIC, 8);
+
+    ssd->stats_page = pg;
+    ftl_stats_publish(ssd, 0);
+    ftl_log("stats: publishing to %s\n", path);
+}
+
+static void ftl_stats_publish(struct ssd *ssd, int64_t now)
+{
+    struct ftl_stats_page *pg = ssd->stats_page;
+    struct line_mgmt *lm = &ssd->lm;
+    uint64_t seq = pg->seq;
+
+    __atomic_store_n(&pg->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    pg->stime = now;
+    pg->nr_updates++;
+    pg->host_writes = ssd->host_writes;
+    pg->nand_writes = ssd->nand_writes;
+    pg->gc_writes = ssd->gc_writes;
+    memcpy(pg->pool_host_writes, ssd->pool_host_writes, sizeof(pg->pool_host_writes));
+    memcpy(pg->pool_gc_writes, ssd->pool_gc_writes, sizeof(pg->pool_gc_writes));
+    memcpy(pg->pool_gc_cnt, ssd->pool_gc_cnt, sizeof(pg->pool_gc_cnt));
+    memcpy(pg->pool_erases, ssd->pool_erases, sizeof(pg->pool_erases));
+    pg->full_line_cnt = lm->full_line_cnt;
+    pg->nr_temps = ssd->nr_temps;
+    for (int c = 0; c < lm->nr_pools; c++) {
+        pg->free_line_cnt[c] = lm->pool[c].free_cnt;
+        pg->victim_line_cnt[c] = lm->pool[c].victim_cnt;
+        pg->pool_lines[c] = lm->pool[c].lines;
+        pg->pool_target[c] = lm->pool[c].target;
+    }
+    pg->pool_moves = ssd->pool_moves;
+    pg->io_t0 = ssd->io_stats_t0;
+    pg->io_end = io_stats_end(ssd, now);
+    memset(&pg->io, 0, sizeof(pg->io));
+    for (int i = 0; i < ssd->sp.tt_luns; i++) {
+        io_stats_add(&pg->io, &ssd->lun[i].io);
+    }
+    memset(pg->erase_hist, 0, sizeof(pg->erase_hist));
+    pg->erase_min = pg->erase_max = lm->lines[0].erase_cnt;
+    for (int i = 0; i < lm->tt_lines; i++) {
+        int e = lm->lines[i].erase_cnt;
+
+        pg->erase_min = e < pg->erase_min ? e : pg->erase_min;
+        pg->erase_max = e > pg->erase_max ? e : pg->erase_max;
+        pg->erase_hist[erase_hist_bin(e)]++;
+    }
+    pg->wl_moves = ssd->wl_moves;
+    pg->wl_writes = ssd->wl_writes;
+    memcpy(pg->temp_bound, ssd->temp_bound, sizeof(pg->temp_bound));
+    pg->decay_window = ssd->hot_cold_decay_window;
+    pg->uid_tunes = ssd->uid_tunes;
+    memcpy(pg->uid_hist, ssd->uid_hist, sizeof(pg->uid_hist));
+
+    __atomic_store_n(&pg->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/* 요청 처리 후 호출; FTL_STATS_PERIOD_NS 마다만 실제로 갱신 */
+static inline void ftl_stats_update(struct ssd *ssd, int64_t now)
+{
+    if (ssd->stats_page && now >= ssd->stats_next_ns) {
+        ftl_stats_publish(ssd, now);
+        ssd->stats_next_ns = now + FTL_STATS_PERIOD_NS;
+    }
+}
+
+void ftl_stats_close(struct ssd *ssd)
+{
+    if (!ssd->stats_page) {
+        return;
+    }
+
+    ftl_stats_publish(ssd, ssd->stats_page->stime);
+    munmap(ssd->stats_page, sizeof(struct ftl_stats_page));
+    ssd->stats_page = NULL;
+}
+
+/* ===== FTL 스레드 시간 분해 ===== */
+
+static const char *prof_name[PROF_NR] = {
+    [PROF_IDLE]     = "idle",
+    [PROF_RING]     = "ring",
+    [PROF_WRITE]    = "write",
+    [PROF_READ]     = "read",
+    [PROF_TRIM]     = "trim",
+    [PROF_CLASSIFY] = "classify",
+    [PROF_VICTIM]   = "victim",
+    [PROF_RELOCATE] = "relocate",
+    [PROF_DECAY]    = "rekey",
+    [PROF_OTHER]    = "other",
+};
+
+void ftl_prof_enable(struct ssd *ssd, int interval_ms)
+{
+    struct ftl_prof *p = &ssd->prof;
+
+    memset(p->cycles, 0, sizeof(p->cycles));
+    memset(p->cnt, 0, sizeof(p->cnt));
+    p->interval_ns = interval_ms > 0 ? interval_ms * 1000000LL : 0;
+    p->t0_ns = ftl_mono_ns();
+    p->t0_cycles = ftl_cycles();
+    p->last = p->t0_cycles;
+    p->cur = PROF_IDLE;
+    p->on = true;
+}
+
+void ftl_prof_disable(struct ssd *ssd)
+{
+    if (!ssd->prof.on) {
+        return;
+    }
+    ftl_print_prof(ssd);
+    ssd->prof.on = false;
+}
+
+void ftl_print_prof(struct ssd *ssd)
+{
+    struct ftl_prof *p = &ssd->prof;
+    uint64_t now = ftl_cycles();
+    int64_t now_ns = ftl_mono_ns();
+    uint64_t total = 0;
+    double cyc_per_ns;
+
+    if (!p->on) {
+        return;
+    }
+
+    p->cycles[p->cur] += now - p->last;
+    p->last = now;
+    for (int i = 0; i < PROF_NR; i++) {
+        total += p->cycles[i];
+    }
+    cyc_per_ns = now_ns > p->t0_ns ? (double)(now - p->t0_cycles) / (now_ns - p->t0_ns)
+                                   : 1.0;
+
+    ftl_log("========== FTL thread profile (%.3f s) ==========\n",
+            (now_ns - p->t0_ns) / 1e9);
+    ftl_log("busy %.1f%%, idle %.1f%%\n",
+            total ? 100.0 * (total - p->cycles[PROF_IDLE]) / total : 0.0,
+            total ? 100.0 * p->cycles[PROF_IDLE] / total : 0.0);
+    for (int i = 0; i < PROF_NR; i++) {
+        if (i == PROF_IDLE || !p->cycles[i]) {
+            continue;
+        }
+        ftl_log("  %-9s %5.1f%% %10.3f ms %10lu calls %8.1f ns/call\n",
+                prof_name[i], 100.0 * p->cycles[i] / total,
+                p->cycles[i] / cyc_per_ns / 1e6, p->cnt[i],
+                p->cnt[i] ? p->cycles[i] / cyc_per_ns / p->cnt[i] : 0.0);
+    }
+    ftl_log("=================================================\n");
+
+    memset(p->cycles, 0, sizeof(p->cycles));
+    memset(p->cnt, 0, sizeof(p->cnt));
+    p->t0_ns = now_ns;
+    p->t0_cycles = now;
+}
+
+void ftl_request_prof(struct ssd *ssd, int interval_ms)
+{
+    __atomic_store_n(&ssd->prof_req, interval_ms > 0 ? interval_ms : 0,
+                     __ATOMIC_RELEASE);
+    ftl_kick(ssd);
+}
+
+/* FTL 스레드 루프마다: 다른 스레드의 켜기/끄기 요청 적용, 주기가 됐으면 출력 */
+static inline void ftl_prof_tick(struct ssd *ssd)
+{
+    struct ftl_prof *p = &ssd->prof;
+
+    if (__atomic_load_n(&ssd->prof_req, __ATOMIC_RELAXED) >= 0) {
+        int ms = __atomic_exchange_n(&ssd->prof_req, -1, __ATOMIC_ACQUIRE);
+
+        if (ms > 0) {
+            ftl_prof_enable(ssd, ms);
+        } else {
+            ftl_prof_disable(ssd);
+        }
+    }
+    if (p->on && p->interval_ns && ftl_mono_ns() - p->t0_ns >= p->interval_ns) {
+        ftl_print_prof(ssd);
+    }
+}
+
+/* ===== 요청 latency 히스토그램 ===== */
+
+static inline int lat_hist_bucket(uint64_t v)
+{
+    int msb, shift;
+
+    if (v < LAT_HIST_SUB) {
+        return v;
+    }
+    msb = 63 - __builtin_clzll(v);
+    if (msb >= LAT_HIST_MAX_BITS) {
+        return LAT_HIST_BUCKETS - 1;
+    }
+    shift = msb - LAT_HIST_SUB_BITS;
+    return (shift + 1) * LAT_HIST_SUB + (int)((v >> shift) - LAT_HIST_SUB);
+}
+
+/* bucket에 들어갈 수 있는 가장 큰 값 */
+static inline uint64_t lat_hist_bucket_high(int idx)
+{
+    int shift;
+
+    if (idx < (int)LAT_HIST_SUB) {
+        return idx;
+    }
+    shift = idx / LAT_HIST_SUB - 1;
+    return ((uint64_t)(idx % LAT_HIST_SUB + LAT_HIST_SUB + 1) << shift) - 1;
+}
+
+static inline void lat_hist_add(struct lat_hist *h, uint64_t v)
+{
+    h->cnt[lat_hist_bucket(v)]++;
+    h->n++;
+    h->sum += v;
+    if (v > h->max) {
+        h->max = v;
+    }
+}
+
+/* p (0~1) 분위수: 해당 bucket 상한 (max로 clamp) */
+static uint64_t lat_hist_percentile(struct lat_hist *h, double p)
+{
+    uint64_t target = (uint64_t)(p * h->n + 0.999999);
+    uint64_t acc = 0;
+
+    if (target == 0) {
+        target = 1;
+    }
+    for (int i = 0; i < LAT_HIST_BUCKETS; i++) {
+        acc += h->cnt[i];
+        if (acc >= target) {
+            uint64_t v = lat_hist_bucket_high(i);
+            return v < h->max ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+static inline void ftl_lat_record(struct ssd *ssd, NvmeRequest *req, uint64_t lat)
+{
+    int op;
+
+    switch (req->cmd.opcode) {
+    case NVME_CMD_WRITE:
+        op = LAT_OP_WRITE;
+        break;
+    case NVME_CMD_READ:
+        op = LAT_OP_READ;
+        break;
+    case NVME_CMD_DSM:
+        op = LAT_OP_DSM;
+        break;
+    default:
+        return;
+    }
+
+    lat_hist_add(&ssd->lat_hist[op][0], lat);
+    if (ssd->req_gc_stalled) {
+        lat_hist_add(&ssd->lat_hist[op][1], lat);
+    }
+}
+
+void ftl_reset_lat_stats(struct ssd *ssd)
+{
+    memset(ssd->lat_hist, 0, sizeof(ssd->lat_hist));
+}
+
+void ftl_print_lat_stats(struct ssd *ssd)
+{
+    static const char *opname[LAT_OP_NR] = { "write", "read", "dsm" };
+
+    ftl_log("========== Latency (us) ==========\n");
+    for (int op = 0; op < LAT_OP_NR; op++) {
+        struct lat_hist *h = &ssd->lat_hist[op][0];
+        struct lat_hist *g = &ssd->lat_hist[op][1];
+
+        if (h->n == 0) {
+            continue;
+        }
+        ftl_log("%-5s n=%lu avg=%.1f p50=%.1f p99=%.1f p99.9=%.1f max=%.1f\n",
+                opname[op], h->n, (double)h->sum / h->n / 1000.0,
+                lat_hist_percentile(h, 0.50) / 1000.0,
+                lat_hist_percentile(h, 0.99) / 1000.0,
+                lat_hist_percentile(h, 0.999) / 1000.0,
+                h->max / 1000.0);
+        if (g->n) {
+            ftl_log("%-5s   GC-stalled n=%lu (%.2f%%) p50=%.1f p99=%.1f max=%.1f\n",
+                    opname[op], g->n, (double)g->n / h->n * 100.0,
+                    lat_hist_percentile(g, 0.50) / 1000.0,
+                    lat_hist_percentile(g, 0.99) / 1000.0,
+                    g->max / 1000.0);
+        }
+    }
+    ftl_log("==================================\n");
+}
+
+void ftl_request_lat_dump(struct ssd *ssd, bool reset)
+{
+    __atomic_store_n(&ssd->lat_dump_req, reset ? 2 : 1, __ATOMIC_RELEASE);
+    ftl_kick(ssd);
+}
+
+static inline void ftl_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/*
+ * poller 하나의 to_ftl ring에서 요청을 최대 ring_batch개 꺼내 처리하고, 완료는 한 번에 돌려줌.
+ * 통계 페이지 갱신, background GC, static WL처럼 요청 사이에 하던 일은 batch마다 한 번
+ * (background GC step은 요청 수만큼 크게). 처리한 요청 수를 반환.
+ */
+static int ftl_poll_ring(struct ssd *ssd, int poller)
+{
+    NvmeRequest *reqs[FTL_RING_BATCH_MAX];
     uint64_t lat = 0;
-    int rc;
+    bool stalled = false;
+    int nr, rc;
+
+    prof_switch(ssd, PROF_RING);
+    nr = femu_ring_dequeue(ssd->to_ftl[poller], (void **)reqs, ssd->ring_batch);
+    if (!nr) {
+        prof_switch(ssd, PROF_OTHER);
+        return 0;
+    }
+
+    for (int k = 0; k < nr; k++) {
+        NvmeRequest *req = reqs[k];
+
+        prof_switch(ssd, PROF_OTHER);
+        ftl_assert(req);
+        ssd->last_req_ns = req->stime;
+        ssd->req_gc_stalled = false;
+        /* ssd_trim()이 dsm_ranges를 해제하므로 처리 전에 기록 */
+        if (ssd->trace) {
+            ftl_trace_record(ssd, req, poller);
+        }
+
+        switch (req->cmd.opcode) {
+        case NVME_CMD_WRITE:
+            prof_switch(ssd, PROF_WRITE);
+            lat = ssd_write(ssd, req);
+            break;
+        case NVME_CMD_READ:
+            prof_switch(ssd, PROF_READ);
+            lat = ssd_read(ssd, req);
+            break;
+        case NVME_CMD_DSM:
+            prof_switch(ssd, PROF_TRIM);
+            if (req->dsm_ranges && req->dsm_nr_ranges > 0) {
+                lat = ssd_trim(ssd, req);
+            }
+            break;
+        default:
+            //ftl_err("FTL received unkown request type, ERROR\n");
+            ;
+        }
+
+        prof_switch(ssd, PROF_OTHER);
+        req->reqlat = lat;
+        req->expire_time += lat;
+        ftl_lat_record(ssd, req, lat);
+    }
+
+    /* 완료를 하나라도 버리면 guest I/O가 끝나지 않으므로 poller가 비워 줄 때까지 다시 넣음 */
+    prof_switch(ssd, PROF_RING);
+    for (int done = 0; done < nr; done += rc) {
+        rc = femu_ring_enqueue(ssd->to_poller[poller], (void **)reqs + done, nr - done);
+        if (rc < nr - done) {
+            if (!stalled) {
+                ftl_err("FTL to_poller ring full (%d/%d), retrying\n", done + rc, nr);
+                stalled = true;
+            }
+            ftl_cpu_relax();
+        }
+    }
+    prof_switch(ssd, PROF_OTHER);
+
+    ftl_stats_update(ssd, reqs[nr - 1]->stime);
+
+    /* background GC를 batch 사이사이에 한 step씩 (free line 수와 batch 크기에 따라 조절) */
+    gc_background_step(ssd, nr);
+    wear_level_static(ssd);
+
+    return nr;
+}
+
+void ftl_kick(struct ssd *ssd)
+{
+    /* enqueue(ring head)와 idle_sleeping 읽기 사이 full fence: ftl_idle_sleep과 짝 */
+    __atomic_add_fetch(&ssd->idle_futex, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ssd->idle_sleeping, __ATOMIC_RELAXED)) {
+        syscall(SYS_futex, &ssd->idle_futex, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+/* 처리할 일이 생겼는지: 요청이 있는 ring, 다른 스레드의 출력/profiler 요청 */
+static bool ftl_has_work(struct ssd *ssd, FemuCtrl *n)
+{
+    if (__atomic_load_n(&ssd->lat_dump_req, __ATOMIC_RELAXED) ||
+        __atomic_load_n(&ssd->prof_req, __ATOMIC_RELAXED) >= 0) {
+        return true;
+    }
+    for (int i = 1; i <= n->nr_pollers; i++) {
+        if (ssd->to_ftl[i] && femu_ring_count(ssd->to_ftl[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* 최대 idle_sleep_ns 동안 futex에서 잠듦 (ftl_kick이 부르면 바로 깸) */
+static void ftl_idle_sleep(struct ssd *ssd, FemuCtrl *n)
+{
+    struct timespec ts = {
+        .tv_sec = ssd->idle_sleep_ns / 1000000000LL,
+        .tv_nsec = ssd->idle_sleep_ns % 1000000000LL,
+    };
+    uint32_t seq = __atomic_load_n(&ssd->idle_futex, __ATOMIC_ACQUIRE);
+
+    /* 잠든다고 알린 뒤에 ring을 다시 봄: 그 사이 enqueue는 여기서 보이거나 futex 값을 바꿈 */
+    __atomic_store_n(&ssd->idle_sleeping, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (!ftl_has_work(ssd, n)) {
+        ssd->idle_sleeps++;
+        if (syscall(SYS_futex, &ssd->idle_futex, FUTEX_WAIT_PRIVATE, seq,
+                    &ts, NULL, 0) == 0) {
+            ssd->idle_kicks++;
+        }
+    }
+    __atomic_store_n(&ssd->idle_sleeping, 0, __ATOMIC_RELAXED);
+}
+
+/* 모든 ring이 비었을 때 한 번: 비어 있던 시간(idle_t0부터)에 따라 spin → yield → sleep */
+static void ftl_idle_wait(struct ssd *ssd, FemuCtrl *n, int64_t *idle_t0)
+{
+    int64_t now, idle;
+
+    if (!ssd->idle_backoff) {
+        return;
+    }
+    now = ftl_mono_ns();
+    if (!*idle_t0) {
+        *idle_t0 = now;
+    }
+    idle = now - *idle_t0;
+
+    if (idle < ssd->idle_spin_ns) {
+        ftl_cpu_relax();
+    } else if (idle < ssd->idle_yield_ns || !ssd->idle_sleep_ns) {
+        sched_yield();
+    } else {
+        ftl_idle_sleep(ssd, n);
+    }
+}
+
+static void *ftl_thread(void *arg)
+{
+    FemuCtrl *n = (FemuCtrl *)arg;
+    struct ssd *ssd = n->ssd;
+    int64_t idle_t0 = 0;
+    bool busy;
     int i;
 
     /* WAF 출력을 위한 카운터 */
@@ -1670,52 +4021,42 @@ static void *ftl_thread(void *arg)
     ssd->to_poller = n->to_poller;
 
     while (1) {
+        /* flip 명령 등으로 요청된 latency 출력 */
+        if (__atomic_load_n(&ssd->lat_dump_req, __ATOMIC_RELAXED)) {
+            int req_type = __atomic_exchange_n(&ssd->lat_dump_req, 0,
+                                               __ATOMIC_ACQUIRE);
+            ftl_print_lat_stats(ssd);
+            if (req_type == 2) {
+                ftl_reset_lat_stats(ssd);
+            }
+        }
+        ftl_prof_tick(ssd);
+        prof_switch(ssd, PROF_IDLE);
+
+        busy = false;
         for (i = 1; i <= n->nr_pollers; i++) {
             if (!ssd->to_ftl[i] || !femu_ring_count(ssd->to_ftl[i]))
                 continue;
 
-            rc = femu_ring_dequeue(ssd->to_ftl[i], (void *)&req, 1);
-            if (rc != 1) {
-                printf("FEMU: FTL to_ftl dequeue failed\n");
-            }
-
-            ftl_assert(req);
-            switch (req->cmd.opcode) {
-            case NVME_CMD_WRITE:
-                lat = ssd_write(ssd, req);
-                break;
-            case NVME_CMD_READ:
-                lat = ssd_read(ssd, req);
-                break;
-            case NVME_CMD_DSM:
-                if (req->dsm_ranges && req->dsm_nr_ranges > 0) {
-                    lat = ssd_trim(ssd, req);
-                }
-                break;
-            default:
-                //ftl_err("FTL received unkown request type, ERROR\n");
-                ;
-            }
-
-            req->reqlat = lat;
-            req->expire_time += lat;
-
-            rc = femu_ring_enqueue(ssd->to_poller[i], (void *)&req, 1);
-            if (rc != 1) {
-                ftl_err("FTL to_poller enqueue failed\n");
-            }
+            busy |= ftl_poll_ring(ssd, i) > 0;
 
             /* 주기적으로 WAF 출력 */
             if ((ssd->host_writes - last_print_host_writes) >= PRINT_DATA_INTERVAL) {
                 print_waf_stats(ssd);
                 last_print_host_writes = ssd->host_writes;
             }
-            
-            /* clean one line if needed (in the background) */
-            if (should_gc(ssd)) {
-                do_gc(ssd, false);
-            }
         }
+
+        if (busy) {
+            idle_t0 = 0;
+            continue;
+        }
+
+        /* 모든 ring이 비었음: 다음 burst 전에 free line 확보, 그 다음 backoff */
+        if (ssd->idle_gc_lines) {
+            gc_idle_step(ssd, qemu_clock_get_ns(QEMU_CLOCK_REALTIME));
+        }
+        ftl_idle_wait(ssd, n, &idle_t0);
     }
 
     return NULL;
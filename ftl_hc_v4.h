@@ -44,9 +44,24 @@ enum {
     FEMU_RESET_ACCT = 5,
     FEMU_ENABLE_LOG = 6,
     FEMU_DISABLE_LOG = 7,
+
+    FEMU_PRINT_LAT_STATS = 8,
+    FEMU_RESET_LAT_STATS = 9,
+
+    FEMU_ENABLE_FTL_PROF = 10,
+    FEMU_DISABLE_FTL_PROF = 11,
 };
 
 
+/*
+ * FTL_COMPACT_MAP:
+ *   - 정의하면 maptbl은 32비트 물리 페이지 인덱스(ppa2pgidx 형태),
+ *     rmap은 32비트 LPN을 저장 → 가장 큰 두 테이블 크기가 절반
+ *   - struct ppa 는 필요할 때(get_maptbl_ent)만 pgidx에서 풀어서 사용
+ *   - tt_pgs < 2^32 인 장치에서만 사용 가능 (ssd_init에서 확인)
+ */
+//#define FTL_COMPACT_MAP
+
 #define BLK_BITS    (16)
 #define PG_BITS     (16)
 #define SEC_BITS    (8)
@@ -76,26 +91,224 @@ enum {
 /* 대략 1GiB(= 262,144 pages * 4KiB/page)마다 한 번 decay */
 #define HOT_DECAY_WINDOW_PAGES   (ssd->sp.tt_pgs / 10)
 
-/* "짧은 interval" 을 정의하는 host write 간격 (pages 단위) */
+/*
+ * Cold Cost-Benefit key를 다시 계산하는 주기 (host_writes 기준).
+ * 라인 수에 비례하므로 전체 재계산 비용이 GC 한 번당 상수로 분할상환됨.
+ */
+#define COLD_CB_EPOCH_PAGES      (ssd->sp.tt_pgs / 64)
+
+/*
+ * "짧은 interval" 을 정의하는 host write 간격 (pages 단위).
+ * UID tuner가 켜져 있으면 (FEMU_FTL_UID_TUNE, 기본 켜짐) 시작값이자 하한이고,
+ * 실제 값은 ssd->temp_bound[Hot]
+ */
 #define HOT_INTERVAL_THRESHOLD_PAGES    (64ULL)
 
+/* Hot LPN의 delta가 Hot 경계의 이 배수를 넘으면 강등 */
+#define HOT_DEMOTE_FACTOR               (4ULL)
+
 /* window 내 최소 접근 횟수 */
 #define HOT_ACCESS_THRESHOLD            (3U)
 
 /* 짧은 interval 패턴이 몇 번 이상 반복되면 HOT 확정 */
 #define HOT_INTERVAL_CONFIRM_COUNT      (2U)
 
-/* LPN state: 최대한 단순하게 Hot / Cold 두 상태만 사용 */
-typedef enum {
-    LPN_STATE_COLD = 0,
-    LPN_STATE_HOT  = 1,
-} lpn_state_t;
+/*
+ * ========= UID 기반 Hot 경계 자동 조정 =========
+ *
+ * 쓰기 기준으로 본 update interval의 평균은 워크로드와 상관없이 "쓰인 LPN 수" U와 같음.
+ * 모든 LPN이 똑같이 쓰이면 (uniform random) interval은 평균 U인 지수 분포를 따르므로,
+ * UID_TUNE_PAGES마다 최근 uid_hist (반감기 한 주기)의 누적 분포를 그 기준 분포와
+ * 비교해서 2^(b+1) 이하 비율이 기준의 UID_TUNE_RATIO배 이상인 가장 큰 경계를
+ * short-lived 구간과 long tail 사이의 knee로 보고 Hot 경계로 씀.
+ * 그런 구간이 없으면 (skew 없음) HOT_INTERVAL_THRESHOLD_PAGES로 돌아감.
+ * 단, 그 경계로 Hot에 남을 LPN 수 (Little's law: 강등 전 interval들의 비율 × 길이 합)가
+ * 처음 Hot pool 크기의 UID_TUNE_HOT_FILL_PCT%를 넘으면 한 단계 아래에서 멈춤.
+ * 8%는 ftl_sim zipf / hotcold / groups에서 가장 좋았던 값 (50%면 Hot pool이 넘쳐 WAF 2배 가까이).
+ *
+ * access_cnt / short_int 가 Hot 경계보다 짧은 window에서 먼저 사라지지 않도록
+ * decay window도 max(HOT_DECAY_WINDOW_PAGES, Hot 경계 × HOT_DECAY_MIN_INTERVALS)로 맞춤.
+ */
+#define UID_TUNE_PAGES                  (ssd->sp.tt_pgs / 16)
+#define UID_TUNE_RATIO                  (2)
+#define UID_TUNE_HOT_FILL_PCT           (8)
+#define UID_TUNE_MIN_SAMPLES            (1024)
+#define HOT_DECAY_MIN_INTERVALS         (4)
+
+/* ========= Wear-leveling ========= */
+/*
+ * Dynamic: free line은 항상 erase 횟수가 가장 적은 것부터 꺼냄 (같으면 먼저 들어온 것).
+ *
+ * Static: line erase가 WL_CHECK_ERASES 번 일어날 때마다
+ *   (가장 많이 지워진 free line) - (가장 적게 지워진 닫힌 line) >= WL_STATIC_THRESHOLD 이면
+ *   그 닫힌 line(오래 안 바뀐 static data)을 relocate해서 풀어주고,
+ *   두 line이 다른 pool이면 pool 소속을 맞바꿈 → 닳은 line은 static 쪽 pool에서 쉬고
+ *   젊은 line은 쓰기가 몰리는 pool로 감.
+ */
+#define WL_CHECK_ERASES                 (32)
+#define WL_STATIC_THRESHOLD             (16)
+
+/* line erase 횟수 히스토그램: bin 0 = 0회, bin b = [2^(b-1), 2^b) */
+#define ERASE_HIST_BINS                 (16)
+
+/* ========= Incremental GC ========= */
+/*
+ * background GC는 victim 하나를 여러 step으로 나눠 relocate (struct gc_job).
+ * ftl_thread는 요청 하나를 처리할 때마다 한 step을 진행하고, step당 페이지 수는
+ * free line이 gc_thres_lines → gc_thres_lines_high로 줄어드는 동안
+ * GC_STEP_MIN_PAGES → GC_STEP_MAX_PAGES로 선형 증가. erase는 마지막 step에서 한꺼번에.
+ */
+#define GC_STEP_MIN_PAGES               (1)
+#define GC_STEP_MAX_PAGES               (32)
+
+/* ========= Idle GC ========= */
+/*
+ * ring이 IDLE_GC_DELAY_NS 이상 비어 있고 모든 LUN이 쉬고 있으면 다음 burst 전에 GC를 미리:
+ *   1) valid page가 없는 victim (relocate 없이 erase만 하면 되는 라인)부터 비우고
+ *   2) free line이 gc_thres_lines + idle_gc_lines 이하인 동안 평소(!force) 기준 victim을 거둠
+ * step 하나는 LUN당 페이지 하나 분량이라, burst가 시작될 때 앞에 밀려 있는 GC는 최대 step 하나.
+ * FEMU_FTL_IDLE_GC=<전체 라인 대비 %> (기본 IDLE_GC_DEFAULT_PCT, 0이면 끔)
+ */
+#define IDLE_GC_DELAY_NS                (1000000LL)
+#define IDLE_GC_DEFAULT_PCT             (5)
+
+/* ========= GC pacing ========= */
+/*
+ * free line이 gc_thres_lines 이하이면 host 쓰기가 쓰는 페이지 수에 비례해 GC를 직접 진행
+ * (token bucket). host 페이지 하나당 credit은
+ *   v / (P - v) × (gc_thres_lines - gc_thres_lines_high) / (free - gc_thres_lines_high)
+ * (v = 진행 중인 victim의 valid 페이지, P = pgs_per_line). 앞쪽은 victim 하나를 비워
+ * free 페이지가 줄지 않을 만큼, 뒤쪽은 free line이 high 기준에 가까울수록 커지는 여유분.
+ * credit은 GC_PACE_BURST_PAGES까지만 쌓이고, 페이지 하나 옮길 때마다 1씩 씀
+ * (fixed point, 1 page = 1 << GC_PACE_SHIFT). 그래도 high 기준까지 내려가면 예전처럼 line 단위
+ * foreground GC. FEMU_FTL_GC_PACE=0이거나 gc_thres_lines <= gc_thres_lines_high이면
+ * pacing 없이 foreground GC만.
+ */
+#define GC_PACE_SHIFT                   (8)
+#define GC_PACE_BURST_PAGES             (64)
+
+/* ========= Ring batching ========= */
+/*
+ * ftl_thread는 poller ring마다 요청을 최대 ring_batch개 한 번에 꺼내 처리하고 완료도 한 번에 넣음.
+ * 통계 페이지 갱신, WAF 출력 확인, background GC step, static WL 확인은 batch마다 한 번.
+ * FEMU_FTL_RING_BATCH=<1..FTL_RING_BATCH_MAX> (기본 FTL_RING_BATCH_DEFAULT, 1이면 하나씩)
+ */
+#define FTL_RING_BATCH_DEFAULT          (16)
+#define FTL_RING_BATCH_MAX              (64)
+
+/* ========= Idle backoff ========= */
+/*
+ * 모든 to_ftl ring이 비어 있으면 ftl_thread는 비어 있던 시간에 따라
+ *   idle_spin_ns까지    pause 명령을 넣어 가며 계속 poll
+ *   idle_yield_ns까지   poll 사이에 sched_yield
+ *   그 뒤              idle_sleep_ns > 0이면 futex에서 잠듦. poller가 enqueue 뒤 ftl_kick()을
+ *                      부르면 바로 깨고, 부르지 않아도 idle_sleep_ns마다 깨서 ring을 확인
+ *                      (잠든 동안 추가 지연의 상한). 0이면 계속 yield
+ * FEMU_FTL_IDLE_SPIN_US / FEMU_FTL_IDLE_YIELD_US / FEMU_FTL_IDLE_SLEEP_US,
+ * FEMU_FTL_IDLE_BACKOFF=0이면 예전처럼 계속 spin.
+ * NVMe poller는 아직 ftl_kick()을 부르지 않으므로 sleep은 기본으로 끔 (요청 지연이 늘어남);
+ * poller가 kick하게 되면 FEMU_FTL_IDLE_SLEEP_US=100 정도로 켬.
+ */
+#define FTL_IDLE_SPIN_US_DEFAULT        (50)
+#define FTL_IDLE_YIELD_US_DEFAULT       (1000)
+#define FTL_IDLE_SLEEP_US_DEFAULT       (0)
+
+/* ========= GC relocation stream ========= */
+/*
+ * GC가 옮기는 페이지는 host write pointer 대신 class별 GC 전용 write pointer
+ * (ssd->wp_gc[cls][age])로 씀. GC에서 살아남은 데이터끼리 모아 두면 그 라인은 다시
+ * invalid가 잘 안 생기고, host 라인에는 곧 덮어써질 데이터만 남음.
+ * age는 LPN이 마지막으로 host에 쓰인 뒤 지난 host 쓰기 수; 지금까지 옮긴 페이지 age의
+ * 이동 평균(gc_age_avg) 이상이면 old 그룹.
+ * GC 라인은 해당 class pool에서 필요할 때 열고, 다 쓰면 다음 GC 쓰기 때까지 닫아 둠.
+ * FEMU_FTL_GC_STREAMS=0 (host WP 공유) / 1 (class마다 하나, 기본) / 2 (class x young/old)
+ */
+#define GC_AGE_GROUPS                   (2)
+#define GC_STREAMS_DEFAULT              (1)
+#define GC_AGE_AVG_SHIFT                (10)
+
+/* ========= 온도 그룹 ========= */
+/*
+ * LPN 상태와 라인 pool은 온도 그룹 번호 하나로 표현: 0이 가장 차갑고 nr_temps - 1이 Hot.
+ * FEMU_FTL_TEMPS=2..FTL_MAX_TEMPS (기본 FTL_DEFAULT_TEMPS), 2이면 예전 Hot/Cold 구성.
+ *
+ *   - Hot (nr_temps - 1): 아래 HOT_* 승격/강등 조건 그대로
+ *   - 그 사이 그룹 t (1..nr_temps - 2): update interval이 temp_bound[t] 이하이면 t 이상.
+ *     temp_bound[1] = tt_pgs, 그룹이 하나 올라갈 때마다 1/2^TEMP_BAND_SHIFT 로 좁아짐
+ *   - 어느 band에도 안 들면 0 (Cold). 한 번 쓰일 때 한 그룹씩만 이동 (hysteresis)
+ *
+ * pool마다 free list, host/GC write pointer, victim 자료구조가 따로 있음.
+ * GC 정책은 Hot만 ipc bucket Greedy, 나머지는 Cost-Benefit heap (중간 그룹도 Greedy로
+ * 두면 band가 넓은 그룹에 데이터가 몰려 WAF가 크게 나빠짐).
+ * 처음 free line은 Hot에 HOT_POOL_PCT%, 나머지를 다른 그룹이 똑같이 나눠 가짐.
+ * pool이 비면 온도가 가까운 pool부터 빌리고 (POOL_BORROW_RESERVE개는 남김), 그래도 없으면
+ * 예약분까지 빌린 뒤에야 emergency GC.
+ *
+ * Pool 크기 조정 (FEMU_FTL_POOL_RESIZE, 기본 켜짐): POOL_RESIZE_PAGES마다 pool별 목표 라인 수를
+ *   target = (valid 페이지를 담을 라인) + spare × sqrt(w × D) / Σ sqrt(w × D)
+ * 로 다시 계산. w는 최근 host 쓰기 비율, D는 GC 효율로 본 "실효" valid 페이지 수
+ * (최근 GC에서 옮긴 페이지 / 회수한 페이지 × 지금 spare 페이지; GC가 없었으면 valid 페이지 수).
+ * pool의 GC 비용이 D / spare에 비례한다고 보면 Σ w × D / spare를 최소로 하는 분배.
+ * 라인은 GC로 free가 될 때 목표보다 많은 pool에서 가장 모자란 pool로 하나씩 넘어감.
+ */
+#define FTL_MAX_TEMPS                   (4)
+#define FTL_DEFAULT_TEMPS               (3)
+#define TEMP_BAND_SHIFT                 (2)
+#define HOT_POOL_PCT                    (20)
+#define POOL_BORROW_RESERVE             (3)     /* 다른 pool에 빌려줄 때 남겨 둘 free line */
+#define POOL_RESIZE_PAGES               (ssd->sp.tt_pgs / 16)
+#define POOL_MIN_LINES                  (2 + GC_AGE_GROUPS + POOL_BORROW_RESERVE)
+
+/* 라인 pool = 온도 그룹 번호 */
+typedef int line_class_t;
+#define LINE_CLASS_COLD                 (0)
 
-/* LPN Hot/Cold와 별개로, 라인이 어떤 풀에 속하는지 */
-typedef enum {
-    LINE_CLASS_COLD = 0,
-    LINE_CLASS_HOT  = 1,
-} line_class_t;
+enum {
+    GC_POLICY_GREEDY = 0,   /* ipc bucket, 최대 ipc 라인 */
+    GC_POLICY_CB     = 1,   /* Age × ipc indexed heap */
+};
+
+/* 로그/도구용 pool 이름 (nr_temps는 2..FTL_MAX_TEMPS) */
+static inline const char *ftl_temp_name(int nr_temps, int cls)
+{
+    static const char *names[FTL_MAX_TEMPS - 1][FTL_MAX_TEMPS] = {
+        { "cold", "hot" },
+        { "cold", "warm", "hot" },
+        { "cold", "cool", "warm", "hot" },
+    };
+
+    if (nr_temps < 2 || nr_temps > FTL_MAX_TEMPS || cls < 0 || cls >= nr_temps) {
+        return "?";
+    }
+    return names[nr_temps - 2][cls];
+}
+
+/*
+ * LPN별 Hot/Cold 메타데이터 (8바이트 하나로 묶음)
+ *
+ *   last_seq   : 마지막으로 쓰였을 때의 host_writes 하위 40비트 (0이면 아직 안 쓰임)
+ *                delta는 (host_writes - last_seq) mod 2^40 으로 계산 → 4 PiB 까지 정확
+ *   access_cnt : 최근 window 내 접근 횟수 (decay 적용, 255에서 포화)
+ *   short_int  : 짧은 interval이 연속으로 나온 횟수 (255에서 포화)
+ *   state      : 온도 그룹 (0 = Cold .. nr_temps - 1 = Hot)
+ *
+ * 쓰기 한 번에 캐시라인 하나만 건드리도록 예전 4개 배열(17B/LPN)을 합침.
+ */
+#define LPN_SEQ_BITS        (40)
+#define LPN_SEQ_MASK        ((1ULL << LPN_SEQ_BITS) - 1)
+#define LPN_CNT_BITS        (8)
+#define LPN_CNT_MAX         ((1U << LPN_CNT_BITS) - 1)
+#define LPN_SHORT_BITS      (8)
+#define LPN_SHORT_MAX       ((1U << LPN_SHORT_BITS) - 1)
+#define LPN_TEMP_BITS       (2)     /* FTL_MAX_TEMPS <= 4 */
+
+struct lpn_stat {
+    uint64_t last_seq   : LPN_SEQ_BITS;
+    uint64_t access_cnt : LPN_CNT_BITS;
+    uint64_t short_int  : LPN_SHORT_BITS;
+    uint64_t state      : LPN_TEMP_BITS;
+    uint64_t rsv        : 6;
+};
 
 /* describe a physical page addr */
 struct ppa {
@@ -114,39 +327,61 @@ struct ppa {
     };
 };
 
-typedef int nand_sec_status_t;
+#ifdef FTL_COMPACT_MAP
+typedef uint32_t ftl_map_ent_t;     /* maptbl: 물리 페이지 인덱스 */
+typedef uint32_t ftl_rmap_ent_t;    /* rmap: LPN */
+#define UNMAPPED_PGIDX      (UINT32_MAX)
+#define INVALID_RMAP_LPN    (UINT32_MAX)
+#else
+typedef struct ppa ftl_map_ent_t;
+typedef uint64_t ftl_rmap_ent_t;
+#endif
 
-struct nand_page {
-    nand_sec_status_t *sec;
-    int nsecs;
-    int status;
-};
+/*
+ * NAND 상태는 ch → lun → pl → blk → pg 포인터 트리 대신
+ * geometry로 인덱싱되는 평면 배열에 보관:
+ *
+ *   pgidx  = ppa2pgidx()  = blkidx * pgs_per_blk + pg
+ *   blkidx = ppa2blkidx() = ch * blks_per_ch + lun * blks_per_lun
+ *                           + pl * blks_per_pl + blk
+ *
+ * 페이지 상태(PG_FREE/INVALID/VALID)는 페이지당 2비트로 packing,
+ * 블록 카운터는 SoA 배열 (한 번에 할당).
+ * sector 단위 상태는 I/O 경로에서 읽지 않으므로 보관하지 않음.
+ */
+#define PG_STATUS_BITS      (2)
+#define PG_STATUS_MASK      ((1U << PG_STATUS_BITS) - 1)
+#define PGS_PER_STATUS_BYTE (8 / PG_STATUS_BITS)
 
-struct nand_block {
-    struct nand_page *pg;
-    int npgs;
-    int ipc; /* invalid page count */
-    int vpc; /* valid page count */
-    int erase_cnt;
-    int wp; /* current write pointer */
+struct nand_blk_counters {
+    int *ipc;       /* invalid page count */
+    int *vpc;       /* valid page count */
+    int *erase_cnt;
 };
 
-struct nand_plane {
-    struct nand_block *blk;
-    int nblks;
+/*
+ * ssd_advance_status()가 LUN마다 누적하는 통계 ([type]은 USER_IO / GC_IO, [cmd]는 NAND_*)
+ *   busy_ns : NAND가 실제로 명령을 수행한 시간 (pg_rd_lat / pg_wr_lat / blk_er_lat 합)
+ *   wait_ns : 도착 후 LUN이 비기를 기다린 시간 (queueing delay)
+ *   wait_gc_ns : USER_IO wait 중 마지막 GC_IO가 끝나기 전까지의 부분
+ *                (GC는 line 단위로 몰려 들어오므로 "GC 뒤에서 기다린 시간"의 근사)
+ */
+struct nand_io_stats {
+    uint64_t ops[2][3];
+    uint64_t busy_ns[2];
+    uint64_t wait_ns[2];
+    uint64_t wait_gc_ns;
 };
 
 struct nand_lun {
-    struct nand_plane *pl;
-    int npls;
     uint64_t next_lun_avail_time;
     bool busy;
     uint64_t gc_endtime;
+    uint64_t gc_busy_end;       /* 마지막 GC_IO 명령이 끝나는 시각 */
+    struct nand_io_stats io;
 };
 
 struct ssd_channel {
-    struct nand_lun *lun;
-    int nluns;
     uint64_t next_ch_avail_time;
     bool busy;
     uint64_t gc_endtime;
@@ -206,14 +441,21 @@ typedef struct line {
     int ipc; /* invalid page count in this line */
     int vpc; /* valid page count in this line */
     QTAILQ_ENTRY(line) entry; /* in either {free,victim,full} list */
-    size_t pos;
-    line_class_t cls;   /* 이 라인이 Hot 풀인지 Cold 풀인지 */
+    size_t pos;         /* CB victim heap 내 위치 (1-based, 0이면 heap 밖) */
+    bool victim;        /* victim 자료구조(Greedy: ipc bucket, CB: heap)에 들어 있는지 */
+    bool open;          /* 현재 WP가 쓰고 있는 라인인지 */
+    line_class_t cls;   /* 이 라인이 속한 pool (온도 그룹) */
+    int erase_cnt;      /* 라인 단위 erase 횟수 (블록들은 항상 함께 지워짐) */
+    bool gc;            /* gc_job이 relocate 중 (victim 자료구조/full list 밖) */
 
     /* --- Cold Cost-Benefit GC용 메타데이터 (옵션) --- */
     uint64_t last_update_seq; /* 이 라인에 마지막으로 write가 들어온 host_writes 시퀀스 */
-    double   cold_score;      /* Age × (1 - util) 형태로 계산한 점수 (Cold victim 선택용) */
+    uint64_t cold_score;      /* Age × ipc 형태의 Cost-Benefit key (CB victim heap 정렬용) */
 } line;
 
+/* ipc bucket 등에서 쓰는 line 리스트 타입 */
+typedef QTAILQ_HEAD(, line) line_list_t;
+
 /* wp: record next write addr */
 struct write_pointer {
     struct line *curline;
@@ -224,6 +466,39 @@ struct write_pointer {
     int pl;
 };
 
+/*
+ * 온도 그룹 하나의 라인 pool.
+ *
+ * Greedy (victim_bucket):
+ *   - 닫힌(= WP가 다 쓰고 넘어간) 라인 중 ipc > 0 인 라인을
+ *     victim_bucket[ipc] 에 보관 (인덱스 0은 사용 안 함)
+ *   - victim_max_ipc 는 비어있지 않은 bucket 중 최대 ipc (없으면 0)
+ *   - mark_page_invalid() 에서 ipc가 1 늘 때마다 한 칸 위 bucket으로 이동
+ *     → Greedy victim 선택이 라인 수와 무관하게 O(1)
+ *
+ * Cost-Benefit (victim_heap):
+ *   - 닫힌 라인 중 invalid 비율이 25% 이상인 라인만 들어 있는 indexed max-heap
+ *   - key(cold_score)는 cb_epoch_seq 시점의 Age × ipc 로 계산
+ *   - Age는 시간이 지나면 변하므로 COLD_CB_EPOCH_PAGES 마다 전체 key를 다시 계산
+ *     (그 사이에는 ipc 변화만 sift-up으로 반영)
+ */
+struct line_pool {
+    line_list_t free_list;
+    int free_cnt;
+    int victim_cnt;             /* 최적화용 (ipc > 0인 라인 수) */
+    int policy;                 /* GC_POLICY_* */
+
+    line_list_t *victim_bucket;
+    int victim_max_ipc;
+
+    struct line **victim_heap;
+    int victim_heap_sz;
+    uint64_t cb_epoch_seq;
+
+    int lines;                  /* 소속 라인 수 (free + 열린 + 닫힌) */
+    int target;                 /* pool 크기 조정 목표 (꺼져 있으면 처음 크기) */
+};
+
 struct line_mgmt {
     struct line *lines;
     
@@ -231,19 +506,13 @@ struct line_mgmt {
     QTAILQ_HEAD(free_line_list, line) free_line_list;
     QTAILQ_HEAD(full_line_list, line) full_line_list;
     
-    /* Hot/Cold 전용 Free Line 리스트 추가 */
-    QTAILQ_HEAD(hot_free_line_list, line) hot_free_line_list;
-    QTAILQ_HEAD(cold_free_line_list, line) cold_free_line_list;
-    
     int tt_lines;
     int free_line_cnt;          // 레거시 (사용 안 함)
     int full_line_cnt;
-    
-    /* Hot/Cold 전용 카운터 */
-    int hot_free_line_cnt;
-    int cold_free_line_cnt;
-    int hot_victim_line_cnt;    // 최적화용 (ipc > 0인 Hot 라인 수)
-    int cold_victim_line_cnt;   // 최적화용 (ipc > 0인 Cold 라인 수)
+
+    /* 온도 그룹별 pool [0, nr_pools) */
+    struct line_pool pool[FTL_MAX_TEMPS];
+    int nr_pools;
 };
 struct nand_cmd {
     int type;
@@ -251,17 +520,312 @@ struct nand_cmd {
     int64_t stime; /* Coperd: request arrival time */
 };
 
+/*
+ * ===== I/O trace (FEMU_FTL_TRACE=<path> 일 때만 기록) =====
+ *
+ * 파일 = 헤더 16B (magic 8B, version u32, secs_per_pg u32) + record 나열.
+ * record (정수는 LEB128 varint, "z"는 zigzag 부호 있는 값):
+ *
+ *   tag      u8      bit 0-1: FTL_TRACE_OP_*, bit 2-7: poller (63이면 varint로 이어짐)
+ *   [poller] varint  tag의 poller 필드가 63일 때만
+ *   stime    z       이전 record stime과의 차이 (ns)
+ *   W/R:     slba z  이전 요청의 끝(slba + nlb)과의 차이 → 순차 I/O는 1바이트
+ *            nlb     varint
+ *   DSM:     nr      varint, attributes varint,
+ *            nr × (slba z, nlb varint)   slba 차이 기준은 W/R과 동일
+ *
+ * 기록은 FTL 스레드에서 버퍼에만 쓰고, 채워진 버퍼는 writer 스레드가 파일로 내보냄.
+ * writer가 밀려서 빈 버퍼가 없으면 FTL을 막지 않고 record를 버림 (nr_dropped).
+ * 파일 쓰기가 실패하면 writer가 failed를 세우고 끝나며, 그 뒤 record와 아직 못 쓴 버퍼의
+ * record는 모두 nr_dropped로 셈.
+ */
+#define FTL_TRACE_MAGIC         "FTLTRACE"
+#define FTL_TRACE_VERSION       (1)
+#define FTL_TRACE_HDR_SZ        (16)
+#define FTL_TRACE_BUF_SZ        (1U << 20)
+#define FTL_TRACE_NR_BUFS       (8)
+#define FTL_TRACE_FLUSH_NS      (1000000000LL)  /* 덜 찬 버퍼도 1초마다 내보냄 */
+#define FTL_TRACE_POLLER_ESC    (63)
+#define FTL_TRACE_MAX_VARINT    (10)
+
+enum {
+    FTL_TRACE_OP_WRITE = 0,
+    FTL_TRACE_OP_READ  = 1,
+    FTL_TRACE_OP_DSM   = 2,
+};
+
+struct ftl_trace {
+    FILE *fp;
+    uint8_t *buf[FTL_TRACE_NR_BUFS];
+    uint32_t len[FTL_TRACE_NR_BUFS];
+    uint32_t recs[FTL_TRACE_NR_BUFS];   /* 버퍼에 든 record 수 */
+
+    /* head: FTL 스레드가 채우는 버퍼 번호, tail: writer가 다 쓴 버퍼 수 */
+    uint64_t head;
+    uint64_t tail;
+    uint32_t pos;             /* buf[head % FTL_TRACE_NR_BUFS] 내 offset */
+    uint32_t pos_recs;        /* 그 버퍼에 지금까지 넣은 record 수 */
+
+    /* delta 인코딩 기준 */
+    int64_t prev_stime;
+    uint64_t prev_lba;
+    int64_t seal_stime;
+
+    uint64_t nr_records;
+    uint64_t nr_dropped;
+
+    bool stop;
+    bool failed;              /* writer의 파일 쓰기 실패 (이후 기록 중단) */
+    QemuThread writer;
+};
+
+/*
+ * ===== GC event log (FEMU_FTL_GC_LOG=<path> 일 때만 기록) =====
+ *
+ * 파일 = 헤더 16B (magic 8B, version u32, record 크기 u32) + struct gc_event 나열.
+ * FTL 스레드는 victim마다 고정 크기 ring에 record를 넣기만 하고, 낮은 우선순위
+ * drain 스레드가 주기적으로 파일로 내보냄. ring이 가득 차면 record를 버림 (nr_dropped).
+ * victim마다 ftl_log로 찍던 "[GC] HOT/COLD" 출력은 FEMU_FTL_GC_VERBOSE=1 일 때만.
+ */
+#define FTL_GCLOG_MAGIC         "FTLGCEV\0"
+#define FTL_GCLOG_VERSION       (2)
+#define FTL_GCLOG_HDR_SZ        (16)
+#define FTL_GCLOG_RING_SZ       (4096)      /* 2의 거듭제곱 */
+#define FTL_GCLOG_DRAIN_US      (10000)
+
+enum {
+    GC_EV_FORCE     = 1 << 0,   /* force (high watermark) 기준으로 victim 선택 */
+    GC_EV_EMERGENCY = 1 << 1,   /* free line이 없어 get_next_free_line_*에서 호출 */
+    GC_EV_WL        = 1 << 2,   /* static wear leveling으로 비운 line */
+    GC_EV_INCR      = 1 << 3,   /* background GC가 여러 step에 나눠 relocate */
+    GC_EV_IDLE      = 1 << 4,   /* ring이 비어 있을 때 idle GC가 시작 */
+};
+
+struct gc_event {
+    int64_t stime;          /* GC 시작 시각 (ns, qemu clock) */
+    int64_t emu_ns;         /* 마지막 LUN의 gc_endtime - stime (enable_gc_delay 일 때) */
+    uint32_t cpu_ns;        /* FTL 스레드가 relocate에 쓴 실제 시간 (step 합) */
+    uint32_t line;          /* victim line id */
+    uint32_t ipc;           /* victim 선택 시점 */
+    uint32_t vpc;
+    uint32_t moved;         /* relocate한 페이지 수 */
+    uint8_t cls;            /* victim pool (온도 그룹) */
+    uint8_t flags;          /* GC_EV_* */
+    uint8_t nr_temps;       /* 온도 그룹 수 (pool 이름 표시용) */
+    uint8_t rsvd;
+};
+
+/*
+ * 진행 중인 GC 하나의 상태. 한 step의 GC read가 LUN 하나에 몰리지 않도록
+ * 페이지 번호마다 모든 LUN (ch * luns_per_ch + lun 순)을 돌며 relocate.
+ */
+struct gc_job {
+    struct line *line;      /* NULL이면 진행 중인 GC 없음 */
+    int pg;                 /* 다음에 볼 (pg, lun) */
+    int lun;
+    uint32_t moved;
+    int flags;              /* GC_EV_* */
+    struct gc_event ev;     /* gclog가 켜져 있을 때만 채움 */
+};
+
+struct ftl_gclog {
+    FILE *fp;
+    struct gc_event ring[FTL_GCLOG_RING_SZ];
+
+    /* head: FTL 스레드가 넣은 record 수, tail: drain 스레드가 내보낸 record 수 */
+    uint64_t head;
+    uint64_t tail;
+
+    uint64_t nr_dropped;
+
+    bool stop;
+    QemuThread drainer;
+};
+
+/*
+ * ===== 공유 메모리 통계 페이지 (FEMU_FTL_STATS=<path> 일 때만) =====
+ *
+ * path (예: /dev/shm/femu-ftl-stats)를 mmap해서 FTL 스레드가 FTL_STATS_PERIOD_NS
+ * 마다 카운터를 복사해 둠. 외부 reader (tools/ftl_stats)는 FTL 스레드와 아무것도
+ * 주고받지 않고 seqlock으로 일관된 snapshot만 읽음:
+ *
+ *   writer: seq++ (홀수) → 본문 갱신 → seq++ (짝수)
+ *   reader: s1 = seq (홀수면 재시도) → 본문 복사 → s2 = seq, s1 != s2 면 재시도
+ *
+ * pool별 배열은 온도 그룹 번호 (0 = Cold .. nr_temps - 1 = Hot) 로 인덱스.
+ * pool_gc_writes는 victim line이 속한 pool 기준 (relocate 목적지 pool 아님).
+ */
+#define FTL_STATS_MAGIC         "FTLSTATS"
+#define FTL_STATS_VERSION       (7)
+#define FTL_STATS_PERIOD_NS     (1000000LL)     /* 1ms (요청 stime 기준) */
+
+struct ftl_stats_page {
+    char magic[8];
+    uint32_t version;
+    uint32_t size;                  /* sizeof(struct ftl_stats_page) */
+    uint64_t seq;                   /* 홀수면 갱신 중 */
+
+    int64_t stime;                  /* 마지막 갱신 시각 (ns) */
+    uint64_t nr_updates;
+
+    uint64_t host_writes;
+    uint64_t nand_writes;
+    uint64_t gc_writes;
+    uint64_t pool_host_writes[FTL_MAX_TEMPS];
+    uint64_t pool_gc_writes[FTL_MAX_TEMPS];
+    uint64_t pool_gc_cnt[FTL_MAX_TEMPS];    /* victim line 수 */
+    uint64_t pool_erases[FTL_MAX_TEMPS];    /* block erase 수 */
+
+    int32_t tt_lines;
+    int32_t full_line_cnt;
+    int32_t nr_temps;
+    int32_t rsvd0;
+    int32_t free_line_cnt[FTL_MAX_TEMPS];
+    int32_t victim_line_cnt[FTL_MAX_TEMPS];
+    int32_t pool_lines[FTL_MAX_TEMPS];      /* 소속 라인 수 / 크기 조정 목표 */
+    int32_t pool_target[FTL_MAX_TEMPS];
+    uint64_t pool_moves;
+
+    /*
+     * 전체 LUN 합 (struct nand_io_stats 참고), io_t0 는 마지막 초기화 시각,
+     * io_end 는 max(stime, 가장 늦은 next_lun_avail_time) (이용률 계산 구간의 끝)
+     */
+    int32_t tt_luns;
+    int32_t rsvd;
+    int64_t io_t0;
+    int64_t io_end;
+    struct nand_io_stats io;
+
+    /* wear: line erase 횟수 분포, static WL로 옮긴 line / 페이지 수 */
+    int32_t erase_min;
+    int32_t erase_max;
+    uint64_t erase_hist[ERASE_HIST_BINS];
+    uint64_t wl_moves;
+    uint64_t wl_writes;
+
+    /* 온도 그룹 경계 (temp_bound, Hot 경계는 UID tuner 결과)와 decay window */
+    uint64_t temp_bound[FTL_MAX_TEMPS];
+    uint64_t decay_window;
+    uint64_t uid_tunes;
+    uint64_t uid_hist[UID_HIST_BINS];
+};
+
+/*
+ * ===== FTL 스레드 시간 분해 (FEMU_FTL_PROF=<interval ms> 또는 ftl_request_prof) =====
+ *
+ * 구간마다 rdtsc 하나로 "지금 어느 section에 있는지"를 바꾸는 exclusive-time 방식:
+ * 중첩된 section (예: ssd_write 안의 classify, foreground GC)은 바깥 section에서 빠짐.
+ * 꺼져 있으면 section 경계마다 분기 하나. TSC → ns 환산은 보고 구간마다
+ * CLOCK_MONOTONIC과 비교해서 계산.
+ */
+enum {
+    PROF_IDLE     = 0,  /* 빈 ring polling */
+    PROF_RING     = 1,  /* to_ftl dequeue / to_poller enqueue */
+    PROF_WRITE    = 2,  /* ssd_write: 매핑, 페이지 할당, NAND timing */
+    PROF_READ     = 3,
+    PROF_TRIM     = 4,
+    PROF_CLASSIFY = 5,  /* update_lpn_stats_on_write (lazy decay 적용 포함) */
+    PROF_VICTIM   = 6,  /* select_victim_line_* */
+    PROF_RELOCATE = 7,  /* clean_one_block */
+    PROF_DECAY    = 8,  /* cold victim key 재계산 (decay epoch 자체는 O(1)) */
+    PROF_OTHER    = 9,  /* 통계, trace, 나머지 */
+    PROF_NR       = 10,
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t ftl_cycles(void)
+{
+    return __rdtsc();
+}
+#else
+static inline uint64_t ftl_cycles(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+struct ftl_prof {
+    bool on;
+    int cur;                    /* 지금 시간이 쌓이는 section */
+    uint64_t last;              /* 마지막 section 전환 시각 (cycles) */
+    uint64_t cycles[PROF_NR];
+    uint64_t cnt[PROF_NR];      /* section 진입 횟수 */
+
+    /* 보고 구간 */
+    int64_t interval_ns;        /* 0이면 주기 보고 없음 (ftl_print_prof로만) */
+    int64_t t0_ns;
+    uint64_t t0_cycles;
+};
+
+/*
+ * ===== 요청 latency 히스토그램 (HDR 스타일 log-linear bucket) =====
+ *   - 2^k ~ 2^(k+1) 구간을 LAT_HIST_SUB 개로 균등 분할 → 상대 오차 ~6%
+ *   - LAT_HIST_SUB 미만 값은 1ns 단위 그대로
+ *   - 2^LAT_HIST_MAX_BITS ns 이상은 마지막 bucket에 모음 (max는 정확히 유지)
+ */
+#define LAT_HIST_SUB_BITS   (4)
+#define LAT_HIST_SUB        (1U << LAT_HIST_SUB_BITS)
+#define LAT_HIST_MAX_BITS   (44)
+#define LAT_HIST_BUCKETS    ((LAT_HIST_MAX_BITS - LAT_HIST_SUB_BITS + 1) * LAT_HIST_SUB)
+
+enum {
+    LAT_OP_WRITE = 0,
+    LAT_OP_READ  = 1,
+    LAT_OP_DSM   = 2,
+    LAT_OP_NR    = 3,
+};
+
+struct lat_hist {
+    uint64_t cnt[LAT_HIST_BUCKETS];
+    uint64_t n;
+    uint64_t sum;
+    uint64_t max;
+};
+
 struct ssd {
     char *ssdname;
     struct ssdparams sp;
     struct ssd_channel *ch;
-    struct ppa *maptbl; /* page level mapping table */
-    uint64_t *rmap;     /* reverse mapptbl, assume it's stored in OOB */
+    struct nand_lun *lun;     /* [ch * luns_per_ch + lun] */
+    uint8_t *pg_status;       /* 페이지당 2비트, pgidx로 인덱싱 */
+    struct nand_blk_counters blk; /* blkidx로 인덱싱 */
+    ftl_map_ent_t *maptbl;  /* page level mapping table */
+    ftl_rmap_ent_t *rmap;   /* reverse mapptbl, assume it's stored in OOB */
     struct write_pointer wp;
 
-    struct write_pointer wp_hot;  /* Hot 전용 쓰기 포인터 */
-    struct write_pointer wp_cold; /* Cold 전용 쓰기 포인터 */
-    
+    /*
+     * 온도 그룹 수 (FEMU_FTL_TEMPS)와 그룹 사이 interval 경계 (ftl.h 참고).
+     * temp_bound[nr_temps - 1]은 Hot 경계 (UID tuner가 갱신)
+     */
+    int nr_temps;
+    uint64_t temp_bound[FTL_MAX_TEMPS];
+
+    struct write_pointer wp_pool[FTL_MAX_TEMPS];  /* 온도 그룹별 host 쓰기 포인터 */
+    /* GC 전용 쓰기 포인터 [class][young/old] (curline == NULL이면 열린 라인 없음) */
+    struct write_pointer wp_gc[FTL_MAX_TEMPS][GC_AGE_GROUPS];
+    int gc_streams;                 /* 0, 1, 2 (FEMU_FTL_GC_STREAMS) */
+    bool gc_wp_opening;             /* GC 라인을 여는 중 (중첩된 emergency GC는 host WP로) */
+    uint64_t gc_age_avg;            /* 옮긴 페이지 age의 이동 평균 */
+    uint64_t gc_stream_writes[FTL_MAX_TEMPS][GC_AGE_GROUPS];
+
+    /*
+     * pool 크기 조정 (ftl.h 위쪽 설명): *_win은 지난 조정 이후 증가분 + 이전 값의 절반,
+     * *_prev는 지난 조정 때의 누적값. pool_moves는 다른 pool로 넘어간 free 라인 수
+     */
+    bool pool_resize;
+    uint64_t pool_resize_next;
+    uint64_t pool_moves;
+    uint64_t pool_host_win[FTL_MAX_TEMPS];
+    uint64_t pool_moved_win[FTL_MAX_TEMPS];
+    uint64_t pool_freed_win[FTL_MAX_TEMPS];
+    uint64_t pool_host_prev[FTL_MAX_TEMPS];
+    uint64_t pool_gc_prev[FTL_MAX_TEMPS];
+    uint64_t pool_gc_cnt_prev[FTL_MAX_TEMPS];
+
     struct line_mgmt lm;
 
     /* WAF 측정을 위한 통계 변수 */
@@ -269,54 +833,117 @@ struct ssd {
     uint64_t nand_writes;      // 실제 NAND에 쓴 페이지 수 (GC 포함)
     uint64_t gc_writes;        // GC로 인한 쓰기
 
-    /* ===== LPN 단위 Hot/Cold 분류를 위한 메타데이터 ===== */
+    /* pool별 (line_class_t 인덱스): host 쓰기는 목적지 pool, GC는 victim pool 기준 */
+    uint64_t pool_host_writes[FTL_MAX_TEMPS];
+    uint64_t pool_gc_writes[FTL_MAX_TEMPS];
+    uint64_t pool_gc_cnt[FTL_MAX_TEMPS];
+    uint64_t pool_erases[FTL_MAX_TEMPS];
 
-    /*
-     * lpn_state[lpn]:
-     *   - 해당 LPN이 현재 Hot인지 Cold인지
-     *   - 0: COLD, 1: HOT
-     */
-    lpn_state_t *lpn_state;
+    /* LUN별 I/O 통계 (lun[].io) 를 마지막으로 초기화한 시각; 이용률 계산 기준 */
+    int64_t io_stats_t0;
 
-    /*
-     * lpn_access_cnt[lpn]:
-     *   - 최근 window 내 접근 횟수 (decay 적용)
-     *   - HOT_ACCESS_THRESHOLD 이상이면 "자주 쓰임" 후보
-     */
-    uint32_t *lpn_access_cnt;
+    /* wear-leveling: 전체 line erase 수, 다음 static WL 검사 시점, static WL 실적 */
+    uint64_t line_erases;
+    uint64_t wl_next_check;
+    uint64_t wl_moves;
+    uint64_t wl_writes;
 
-    /*
-     * lpn_last_write_seq[lpn]:
-     *   - 마지막으로 쓰였을 때의 host_writes 값
-     *   - delta = host_writes - last_seq 로 update interval 계산
-     */
-    uint64_t *lpn_last_write_seq;
+    /* ===== LPN 단위 Hot/Cold 분류를 위한 메타데이터 ===== */
 
     /*
-     * lpn_short_int_cnt[lpn]:
-     *   - "짧은 interval(delta <= HOT_INTERVAL_THRESHOLD_PAGES)"가
-     *     연속해서 몇 번 나왔는지
-     *   - HOT_INTERVAL_CONFIRM_COUNT 이상이면 진짜 Hot으로 승격하는 데 사용
+     * lpn_stats[lpn]:
+     *   - state      : 해당 LPN의 온도 그룹 (0: COLD .. nr_temps - 1: HOT)
+     *   - access_cnt : 최근 window 내 접근 횟수, HOT_ACCESS_THRESHOLD 이상이면 "자주 쓰임" 후보
+     *   - last_seq   : delta = host_writes - last_seq 로 update interval 계산
+     *   - short_int  : "짧은 interval(delta <= HOT_INTERVAL_THRESHOLD_PAGES)"가
+     *                  연속해서 몇 번 나왔는지, HOT_INTERVAL_CONFIRM_COUNT 이상이면 Hot 승격에 사용
      */
-    uint8_t *lpn_short_int_cnt;
+    struct lpn_stat *lpn_stats;
 
     /*
      * hot_cold_last_decay_seq:
-     *   - 마지막으로 access_cnt decay를 수행했을 때의 host_writes 값
-     *   - host_writes - last_decay_seq >= HOT_DECAY_WINDOW_PAGES 이면
-     *     lpn_access_cnt 전체를 decay하는 트리거로 사용
+     *   - 마지막으로 decay epoch을 넘긴 시점의 host_writes 값
+     *   - host_writes - last_decay_seq >= hot_cold_decay_window 이면
+     *     hot_cold_decay_epoch 을 1 증가 (전체 배열을 훑지 않음)
+     *
+     * hot_cold_decay_epoch:
+     *   - 지금까지 지나간 decay window 수 (= host_writes / window)
+     *   - LPN별 decay는 쓰기 시점에 lazy하게 적용:
+     *       lpn_epoch = (lpn의 마지막 쓰기 host_writes) / window
+     *       cnt >>= (hot_cold_decay_epoch - lpn_epoch)
+     *     → window마다 전체를 절반으로 줄이던 것과 결과가 동일
      */
     uint64_t hot_cold_last_decay_seq;
+    uint64_t hot_cold_decay_epoch;
+    uint64_t hot_cold_decay_window;   /* HOT_DECAY_WINDOW_PAGES (최소 1), UID tuner가 늘릴 수 있음 */
 
     /*
      * uid_hist[bin]:
      *   - update interval(delta)을 log2 스케일 bin으로 매핑해서
      *     "update interval 분포(UID)"를 근사
-     *   - 분석용 (선택적으로 사용할 수 있음)
+     *   - 누적값은 통계 페이지로, 최근 구간은 UID tuner가 Hot 경계 계산에 사용
+     *
+     * uid_win[bin]: 지난 tune 이후 증가분 + 이전 uid_win의 절반 (uid_prev는 지난 tune 때 uid_hist)
      */
     uint64_t uid_hist[UID_HIST_BINS];
+    bool uid_tune;                      /* FEMU_FTL_UID_TUNE */
+    uint64_t uid_tune_next;             /* 다음 tune 시점 (host_writes) */
+    uint64_t uid_tunes;                 /* Hot 경계가 바뀐 횟수 */
+    uint64_t uid_prev[UID_HIST_BINS];
+    uint64_t uid_win[UID_HIST_BINS];
+
+    /* I/O trace recorder (NULL이면 기록 안 함) */
+    struct ftl_trace *trace;
+
+    /* step 단위로 진행 중인 background GC (line == NULL이면 없음) */
+    struct gc_job gc_job;
+
+    /* idle GC: free line 목표 여유분 (0이면 끔), 마지막 요청 stime, 실적 */
+    int idle_gc_lines;
+    int64_t last_req_ns;
+    uint64_t idle_gc_cnt;
+    uint64_t idle_erase_cnt;        /* 그 중 valid page 없이 erase만 한 라인 */
+
+    /* GC pacing: 켜짐 여부, 남은 credit (fixed point), 실적 */
+    bool gc_pace;
+    int64_t gc_pace_credit;
+    uint64_t gc_pace_pages;         /* host 쓰기가 직접 옮긴 페이지 */
+    uint64_t gc_fg_stalls;          /* line 단위 foreground GC에 들어간 쓰기 요청 */
+
+    /* GC event log (NULL이면 기록 안 함), victim별 ftl_log 여부 */
+    struct ftl_gclog *gclog;
+    bool gc_verbose;
+
+    /* 공유 메모리 통계 페이지 (NULL이면 없음) */
+    struct ftl_stats_page *stats_page;
+    int64_t stats_next_ns;
+
+    /*
+     * lat_hist[op][0]: 해당 opcode 전체 요청의 latency
+     * lat_hist[op][1]: 그 중 foreground GC (ssd_write의 should_gc_high 루프)나
+     *                  emergency GC (get_next_free_line_*)를 기다린 요청만
+     * FTL 스레드만 갱신/출력하고, 다른 스레드는 lat_dump_req로 출력을 요청
+     */
+    struct lat_hist lat_hist[LAT_OP_NR][2];
+    bool req_gc_stalled;        /* 지금 처리 중인 요청이 GC를 기다렸는지 */
+    int lat_dump_req;           /* 0: 없음, 1: 출력, 2: 출력 후 초기화 */
+
+    /* FTL 스레드 시간 분해; prof_req는 다른 스레드의 켜기/끄기 요청 (-1: 없음) */
+    struct ftl_prof prof;
+    int prof_req;
+
+    /* idle backoff 단계 경계 (ns), futex word (ftl_kick마다 증가), 잠들어 있는지, 실적 */
+    bool idle_backoff;
+    int64_t idle_spin_ns;
+    int64_t idle_yield_ns;
+    int64_t idle_sleep_ns;
+    uint32_t idle_futex;
+    int idle_sleeping;
+    uint64_t idle_sleeps;
+    uint64_t idle_kicks;            /* 그 중 ftl_kick으로 깬 횟수 */
 
-    /* lockless ring for communication with NVMe IO thread */
+    /* lockless ring for communication with NVMe IO thread (한 번에 ring_batch개씩) */
+    int ring_batch;
     struct rte_ring **to_ftl;
     struct rte_ring **to_poller;
     bool *dataplane_started_ptr;
@@ -326,17 +953,57 @@ struct ssd {
 void ssd_init(FemuCtrl *n);
 void print_waf_stats(struct ssd *ssd);
 
+/* line erase 횟수 히스토그램과 static WL 실적 */
+void ftl_print_wear_stats(struct ssd *ssd);
+
+/* LUN별 이용률 / 대기 시간 / op 수 (print_waf_stats는 채널 합계만 출력) */
+void ftl_print_lun_stats(struct ssd *ssd);
+void ftl_reset_io_stats(struct ssd *ssd);
+
+/* 남은 trace 버퍼를 내보내고 writer 스레드 종료 */
+void ftl_trace_close(struct ssd *ssd);
+
+/* 남은 GC event를 내보내고 drain 스레드 종료 */
+void ftl_gclog_close(struct ssd *ssd);
+
+/* 통계 페이지 마지막 갱신 후 unmap (파일은 남겨 둠) */
+void ftl_stats_close(struct ssd *ssd);
+
+/* opcode별 latency p50/p99/p99.9/max 출력 (FTL 스레드에서 호출) */
+void ftl_print_lat_stats(struct ssd *ssd);
+void ftl_reset_lat_stats(struct ssd *ssd);
+
+/* 다른 스레드(flip 명령 등)에서: FTL 스레드가 다음 루프에서 출력 (reset이면 이후 초기화) */
+void ftl_request_lat_dump(struct ssd *ssd, bool reset);
+
+/* poller가 to_ftl ring에 넣은 뒤: FTL 스레드가 잠들어 있으면 깨움 (아니면 atomic 하나) */
+void ftl_kick(struct ssd *ssd);
+
+/* FTL 스레드에서: profiler 켜기 (interval_ms마다 출력, 0이면 주기 출력 없음) / 끄기 */
+void ftl_prof_enable(struct ssd *ssd, int interval_ms);
+void ftl_prof_disable(struct ssd *ssd);
+/* 지금까지 쌓인 section별 시간 출력 후 초기화 */
+void ftl_print_prof(struct ssd *ssd);
+/* 다른 스레드에서: interval_ms > 0 이면 켜기, 0 이면 끄기 (FTL 스레드가 다음 루프에서 적용) */
+void ftl_request_prof(struct ssd *ssd, int interval_ms);
+
 /* Hot/Cold 관련 helper 함수 프로토타입 (ftl.c에서 구현 예정) */
 
 /* LPN이 현재 Hot인지 확인 */
 bool ftl_is_lpn_hot(struct ssd *ssd, uint64_t lpn);
 
+/* LPN의 현재 온도 그룹 (= 쓰일 pool) */
+int ftl_lpn_temp(struct ssd *ssd, uint64_t lpn);
+
 /* 쓰기 발생 시 LPN 메타데이터 업데이트 (access_cnt, interval, state 전이 등) */
 void ftl_update_lpn_on_write(struct ssd *ssd, uint64_t lpn);
 
-/* 필요 시 전체 LPN에 대해 access_cnt decay 수행 */
+/* decay window를 넘겼으면 decay epoch 증가 (LPN별 적용은 쓰기 시점에 lazy하게) */
 void ftl_maybe_decay_lpn_stats(struct ssd *ssd);
 
+/* UID_TUNE_PAGES마다 최근 UID 분포에서 Hot 경계를 다시 계산 (ftl.h의 UID tuner 설명 참고) */
+void ftl_maybe_tune_uid(struct ssd *ssd);
+
 #ifdef FEMU_DEBUG_FTL
 #define ftl_debug(fmt, ...) \
     do { printf("[FEMU] FTL-Dbg: " fmt, ## __VA_ARGS__); } while (0)
@@ -0,0 +1,6 @@
+/*
+ * ftl.c includes "ftl.h" as it does inside FEMU (hw/femu/bbssd/ftl.h).
+ * Here it forwards to the header at the top of this repo; that header's
+ * "../nvme.h" then resolves through -I femu/bbssd to femu/nvme.h.
+ */
+#include "../../../ftl_hc_v4.h"
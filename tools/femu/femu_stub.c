@@ -0,0 +1,124 @@
+/*
+ * Host-side implementations for the stand-in nvme.h:
+ * QEMU thread/clock wrappers and a simple femu_ring.
+ */
+#include "nvme.h"
+
+static int64_t stub_clock_ns = -1;
+
+void qemu_thread_create(QemuThread *thread, const char *name,
+                        void *(*start_routine)(void *), void *arg, int mode)
+{
+    (void)name;
+
+    if (pthread_create(&thread->thread, NULL, start_routine, arg) != 0) {
+        fprintf(stderr, "femu-stub: failed to create thread %s\n", name);
+        abort();
+    }
+    if (mode == QEMU_THREAD_DETACHED) {
+        pthread_detach(thread->thread);
+    }
+}
+
+void *qemu_thread_join(QemuThread *thread)
+{
+    void *ret = NULL;
+
+    pthread_join(thread->thread, &ret);
+    return ret;
+}
+
+void femu_stub_set_clock(int64_t now_ns)
+{
+    __atomic_store_n(&stub_clock_ns, now_ns, __ATOMIC_RELAXED);
+}
+
+int64_t qemu_clock_get_ns(int type)
+{
+    int64_t now = __atomic_load_n(&stub_clock_ns, __ATOMIC_RELAXED);
+    struct timespec ts;
+
+    (void)type;
+    if (now >= 0) {
+        return now;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* ===== femu_ring: power-of-2 SPSC ring ===== */
+struct rte_ring {
+    size_t size;        /* power of 2 */
+    size_t mask;
+    size_t head;        /* producer */
+    size_t tail;        /* consumer */
+    void **objs;
+};
+
+struct rte_ring *femu_ring_create(int type, size_t count)
+{
+    struct rte_ring *ring = g_malloc0(sizeof(*ring));
+    size_t size = 1;
+
+    (void)type;
+    while (size < count) {
+        size <<= 1;
+    }
+
+    ring->size = size;
+    ring->mask = size - 1;
+    ring->objs = g_malloc0(sizeof(void *) * size);
+
+    return ring;
+}
+
+void femu_ring_free(struct rte_ring *ring)
+{
+    if (ring) {
+        g_free(ring->objs);
+        g_free(ring);
+    }
+}
+
+size_t femu_ring_count(struct rte_ring *ring)
+{
+    size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    return head - tail;
+}
+
+size_t femu_ring_enqueue(struct rte_ring *ring, void **objs, size_t count)
+{
+    size_t head = ring->head;
+    size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    size_t n = ring->size - (head - tail);
+
+    if (count > n) {
+        count = n;
+    }
+    for (size_t i = 0; i < count; i++) {
+        ring->objs[(head + i) & ring->mask] = objs[i];
+    }
+    __atomic_store_n(&ring->head, head + count, __ATOMIC_RELEASE);
+
+    return count;
+}
+
+size_t femu_ring_dequeue(struct rte_ring *ring, void **objs, size_t count)
+{
+    size_t tail = ring->tail;
+    size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    size_t n = head - tail;
+
+    if (count > n) {
+        count = n;
+    }
+    for (size_t i = 0; i < count; i++) {
+        objs[i] = ring->objs[(tail + i) & ring->mask];
+    }
+    __atomic_store_n(&ring->tail, tail + count, __ATOMIC_RELEASE);
+
+    return count;
+}
@@ -0,0 +1,199 @@
+/*
+ * Minimal stand-in for FEMU's hw/femu/nvme.h so that the blackbox FTL
+ * (ftl.c / ftl.h) can be compiled and driven on a plain Linux host,
+ * without QEMU, glib or a guest.
+ *
+ * Only what ftl.c actually touches is provided: a few glib allocators,
+ * the QTAILQ list macros, QEMU threads/clock, the NVMe request fields the
+ * FTL reads, the femu_ring API and FemuCtrl/BbCtrlParams.
+ */
+#ifndef __FEMU_STUB_NVME_H
+#define __FEMU_STUB_NVME_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/* ===== glib ===== */
+#define g_malloc(sz)        malloc(sz)
+#define g_malloc0(sz)       calloc(1, (sz))
+#define g_free(p)           free(p)
+
+/* ===== qemu/queue.h (tail queue subset) ===== */
+#define QTAILQ_HEAD(name, type)                                         \
+struct name {                                                           \
+    struct type *tqh_first;                                             \
+    struct type **tqh_last;                                             \
+}
+
+#define QTAILQ_ENTRY(type)                                              \
+struct {                                                                \
+    struct type *tqe_next;                                              \
+    struct type **tqe_prev;                                             \
+}
+
+#define QTAILQ_INIT(head) do {                                          \
+    (head)->tqh_first = NULL;                                           \
+    (head)->tqh_last = &(head)->tqh_first;                              \
+} while (0)
+
+#define QTAILQ_FIRST(head)          ((head)->tqh_first)
+#define QTAILQ_EMPTY(head)          ((head)->tqh_first == NULL)
+#define QTAILQ_NEXT(elm, field)     ((elm)->field.tqe_next)
+#define QTAILQ_IN_USE(elm, field)   ((elm)->field.tqe_prev != NULL)
+
+#define QTAILQ_INSERT_HEAD(head, elm, field) do {                       \
+    if (((elm)->field.tqe_next = (head)->tqh_first) != NULL)            \
+        (head)->tqh_first->field.tqe_prev = &(elm)->field.tqe_next;     \
+    else                                                                \
+        (head)->tqh_last = &(elm)->field.tqe_next;                      \
+    (head)->tqh_first = (elm);                                          \
+    (elm)->field.tqe_prev = &(head)->tqh_first;                         \
+} while (0)
+
+#define QTAILQ_INSERT_TAIL(head, elm, field) do {                       \
+    (elm)->field.tqe_next = NULL;                                       \
+    (elm)->field.tqe_prev = (head)->tqh_last;                           \
+    *(head)->tqh_last = (elm);                                          \
+    (head)->tqh_last = &(elm)->field.tqe_next;                          \
+} while (0)
+
+#define QTAILQ_INSERT_BEFORE(listelm, elm, field) do {                  \
+    (elm)->field.tqe_prev = (listelm)->field.tqe_prev;                  \
+    (elm)->field.tqe_next = (listelm);                                  \
+    *(listelm)->field.tqe_prev = (elm);                                 \
+    (listelm)->field.tqe_prev = &(elm)->field.tqe_next;                 \
+} while (0)
+
+#define QTAILQ_REMOVE(head, elm, field) do {                            \
+    if ((elm)->field.tqe_next != NULL)                                  \
+        (elm)->field.tqe_next->field.tqe_prev = (elm)->field.tqe_prev;  \
+    else                                                                \
+        (head)->tqh_last = (elm)->field.tqe_prev;                       \
+    *(elm)->field.tqe_prev = (elm)->field.tqe_next;                     \
+    (elm)->field.tqe_prev = NULL;                                       \
+} while (0)
+
+#define QTAILQ_FOREACH(var, head, field)                                \
+    for ((var) = ((head)->tqh_first); (var); (var) = ((var)->field.tqe_next))
+
+/* ===== qemu/thread.h, qemu/timer.h ===== */
+typedef struct QemuThread {
+    pthread_t thread;
+} QemuThread;
+
+#define QEMU_THREAD_JOINABLE    0
+#define QEMU_THREAD_DETACHED    1
+
+void qemu_thread_create(QemuThread *thread, const char *name,
+                        void *(*start_routine)(void *), void *arg, int mode);
+void *qemu_thread_join(QemuThread *thread);
+
+enum {
+    QEMU_CLOCK_REALTIME = 0,
+};
+
+/*
+ * 시뮬레이터가 femu_stub_set_clock()으로 가상 시간을 정해두면 그 값을,
+ * 아니면 CLOCK_MONOTONIC 을 돌려줌. GC I/O(stime == 0)가 같은 시간축을
+ * 쓰도록 trace 재생 시에는 가상 시간을 사용.
+ */
+int64_t qemu_clock_get_ns(int type);
+void femu_stub_set_clock(int64_t now_ns);
+
+/* ===== byte order (host == little endian 가정) ===== */
+#define le16_to_cpu(x)  (x)
+#define le32_to_cpu(x)  (x)
+#define le64_to_cpu(x)  (x)
+#define cpu_to_le32(x)  (x)
+#define cpu_to_le64(x)  (x)
+
+/* ===== NVMe ===== */
+enum NvmeIoCommands {
+    NVME_CMD_FLUSH      = 0x00,
+    NVME_CMD_WRITE      = 0x01,
+    NVME_CMD_READ       = 0x02,
+    NVME_CMD_DSM        = 0x09,
+};
+
+typedef struct NvmeDsmRange {
+    uint32_t cattr;
+    uint32_t nlb;
+    uint64_t slba;
+} NvmeDsmRange;
+
+typedef struct NvmeCmd {
+    uint8_t  opcode;
+} NvmeCmd;
+
+typedef struct NvmeRequest {
+    NvmeCmd  cmd;
+    uint64_t slba;
+    uint16_t nlb;
+    int64_t  stime;
+    int64_t  reqlat;
+    int64_t  expire_time;
+
+    /* DSM (TRIM) */
+    NvmeDsmRange *dsm_ranges;
+    uint32_t dsm_nr_ranges;
+    uint32_t dsm_attributes;
+} NvmeRequest;
+
+/* ===== femu ring (single producer / single consumer) ===== */
+struct rte_ring;
+
+struct rte_ring *femu_ring_create(int type, size_t count);
+void femu_ring_free(struct rte_ring *ring);
+size_t femu_ring_count(struct rte_ring *ring);
+size_t femu_ring_enqueue(struct rte_ring *ring, void **objs, size_t count);
+size_t femu_ring_dequeue(struct rte_ring *ring, void **objs, size_t count);
+
+enum {
+    FEMU_RING_TYPE_SP_SC = 0,
+    FEMU_RING_TYPE_MP_SC = 1,
+    FEMU_RING_TYPE_MP_MC = 2,
+};
+
+/* ===== FemuCtrl ===== */
+typedef struct BbCtrlParams {
+    int secsz;
+    int secs_per_pg;
+    int pgs_per_blk;
+    int blks_per_pl;
+    int pls_per_lun;
+    int luns_per_ch;
+    int nchs;
+
+    int pg_rd_lat;
+    int pg_wr_lat;
+    int blk_er_lat;
+    int ch_xfer_lat;
+
+    int gc_thres_pcent;
+    int gc_thres_pcent_high;
+} BbCtrlParams;
+
+struct ssd;
+
+typedef struct FemuCtrl {
+    char *devname;
+    struct ssd *ssd;
+    BbCtrlParams bb_params;
+
+    int nr_pollers;
+    struct rte_ring **to_ftl;
+    struct rte_ring **to_poller;
+    bool dataplane_started;
+} FemuCtrl;
+
+#endif
@@ -0,0 +1,613 @@
+/*
+ * ftl_bench: CPU cost of the FTL hot paths on the host.
+ *
+ * For every geometry in the --lines x --luns x --pgs grid the device is
+ * preconditioned (sequential fill of the span + one span of random 4 KiB
+ * writes), then:
+ *
+ *   write       ssd_write() per 4 KiB page (includes foreground GC / decay)
+ *   submit      write + background GC step, i.e. what ftl_thread does per request
+ *   ring1       4 KiB read through the poller rings, one request per dequeue/enqueue
+ *   ring        same with FEMU_FTL_RING_BATCH (default 16) requests per batch
+ *   victim_sel  select_victim_line_*() per call
+ *   gc_page     do_gc_for_line() per relocated page (max = one whole line)
+ *   decay       ftl_maybe_decay_lpn_stats() per call
+ *
+ * ns/op comes from CLOCK_MONOTONIC over the whole loop, cycles/op and max
+ * pause from per-op TSC reads. --json writes one JSON object per row.
+ *
+ * --idle then starts the real ftl_thread on the first geometry and measures
+ * its idle backoff (FEMU_FTL_IDLE_*):
+ *
+ *   idle_cpu    FTL thread CPU while the rings stay empty (ns/op = CPU ns per idle ms)
+ *   idle_spin   same with FEMU_FTL_IDLE_BACKOFF=0
+ *   idle_sleep  same with the futex sleep on (BENCH_IDLE_SLEEP_US)
+ *   wake_*      enqueue -> completion round trip of one 4 KiB read after the
+ *               rings were empty long enough to be spinning / yielding /
+ *               sleeping (kicked with ftl_kick, or not: wake_nokick)
+ */
+#include <errno.h>
+#include <sched.h>
+
+#include "ftl_host.h"
+
+struct bench_opts {
+    int nchs;
+    int lines[16], nr_lines;
+    int luns[16], nr_luns;
+    int pgs[16], nr_pgs;
+    double span;
+    uint64_t ops;           /* 0이면 span 페이지 수 */
+    int gc_lines;           /* gc_page 에서 GC할 라인 수 */
+    uint64_t seed;
+    const char *json;
+    bool idle;
+};
+
+struct bench_row {
+    const char *name;
+    uint64_t ops;
+    double ns_op;
+    double cycles_op;
+    double max_ns;
+};
+
+static double ns_per_cycle;
+static uint64_t rng_state;
+static FILE *json_fp;
+
+static inline uint64_t bench_rand(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ULL;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* TSC 주기 → ns 환산 계수 (약 50 ms busy-wait) */
+static void calibrate(void)
+{
+    uint64_t t0 = now_ns(), c0 = ftl_host_cycles();
+    uint64_t t1, c1;
+
+    do {
+        t1 = now_ns();
+    } while (t1 - t0 < 50000000ULL);
+    c1 = ftl_host_cycles();
+    ns_per_cycle = (double)(t1 - t0) / (double)(c1 - c0);
+}
+
+static int parse_list(const char *arg, int *out, int max)
+{
+    char *buf = strdup(arg), *save = NULL, *tok;
+    int n = 0;
+
+    for (tok = strtok_r(buf, ",", &save); tok && n < max;
+         tok = strtok_r(NULL, ",", &save)) {
+        out[n] = atoi(tok);
+        if (out[n] <= 0) {
+            fprintf(stderr, "bad list value '%s'\n", tok);
+            exit(1);
+        }
+        n++;
+    }
+    free(buf);
+    return n;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --nchs N          channels (default 8)\n"
+            "  --lines L,...     lines = blocks per plane (default 64,256,1024)\n"
+            "  --luns L,...      LUNs per channel (default 4)\n"
+            "  --pgs P,...       pages per block (default 128)\n"
+            "  --span F          fraction of the LBA space written (default 0.7)\n"
+            "  --ops N           write/submit/decay iterations (default span pages)\n"
+            "  --gc-lines N      lines collected for gc_page/victim_sel (default 64)\n"
+            "  --seed N          random seed (default 1)\n"
+            "  --json FILE       also write JSON lines ('-' for stdout)\n"
+            "  --idle            also measure the FTL thread idle backoff\n",
+            prog);
+}
+
+static void parse_opts(struct bench_opts *o, int argc, char **argv)
+{
+    static const struct option longopts[] = {
+        { "nchs",     required_argument, NULL, 'c' },
+        { "lines",    required_argument, NULL, 'b' },
+        { "luns",     required_argument, NULL, 'l' },
+        { "pgs",      required_argument, NULL, 'p' },
+        { "span",     required_argument, NULL, 'S' },
+        { "ops",      required_argument, NULL, 'n' },
+        { "gc-lines", required_argument, NULL, 'g' },
+        { "seed",     required_argument, NULL, 'x' },
+        { "json",     required_argument, NULL, 'j' },
+        { "idle",     no_argument,       NULL, 'i' },
+        { "help",     no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int c;
+
+    memset(o, 0, sizeof(*o));
+    o->nchs = 8;
+    o->nr_lines = parse_list("64,256,1024", o->lines, 16);
+    o->nr_luns = parse_list("4", o->luns, 16);
+    o->nr_pgs = parse_list("128", o->pgs, 16);
+    o->span = 0.7;
+    o->gc_lines = 64;
+    o->seed = 1;
+
+    while ((c = getopt_long(argc, argv, "h", longopts, NULL)) != -1) {
+        switch (c) {
+        case 'c': o->nchs = atoi(optarg); break;
+        case 'b': o->nr_lines = parse_list(optarg, o->lines, 16); break;
+        case 'l': o->nr_luns = parse_list(optarg, o->luns, 16); break;
+        case 'p': o->nr_pgs = parse_list(optarg, o->pgs, 16); break;
+        case 'S': o->span = atof(optarg); break;
+        case 'n': o->ops = strtoull(optarg, NULL, 0); break;
+        case 'g': o->gc_lines = atoi(optarg); break;
+        case 'x': o->seed = strtoull(optarg, NULL, 0); break;
+        case 'j': o->json = optarg; break;
+        case 'i': o->idle = true; break;
+        case 'h':
+        default:
+            usage(argv[0]);
+            exit(c == 'h' ? 0 : 1);
+        }
+    }
+
+    if (o->nchs <= 0 || o->span <= 0 || o->span > 1 || o->gc_lines <= 0) {
+        fprintf(stderr, "invalid --nchs, --span or --gc-lines\n");
+        exit(1);
+    }
+}
+
+static void emit(const BbCtrlParams *bp, const struct bench_row *r)
+{
+    printf("ftl_bench: %3dch x %2dlun x %5dlines x %4dpg  %-10s %10" PRIu64
+           " ops %10.1f ns/op %10.1f cyc/op  max %10.1f us\n",
+           bp->nchs, bp->luns_per_ch, bp->blks_per_pl, bp->pgs_per_blk,
+           r->name, r->ops, r->ns_op, r->cycles_op, r->max_ns / 1000.0);
+
+    if (json_fp) {
+        fprintf(json_fp,
+                "{\"bench\":\"%s\",\"nchs\":%d,\"luns_per_ch\":%d,"
+                "\"lines\":%d,\"pgs_per_blk\":%d,\"ops\":%" PRIu64 ","
+                "\"ns_per_op\":%.2f,\"cycles_per_op\":%.2f,"
+                "\"max_pause_ns\":%.0f}\n",
+                r->name, bp->nchs, bp->luns_per_ch, bp->blks_per_pl,
+                bp->pgs_per_blk, r->ops, r->ns_op, r->cycles_op, r->max_ns);
+        fflush(json_fp);
+    }
+}
+
+static inline void write_req(NvmeRequest *req, uint64_t lpn, int secs_per_pg)
+{
+    memset(req, 0, sizeof(*req));
+    req->cmd.opcode = NVME_CMD_WRITE;
+    req->slba = lpn * secs_per_pg;
+    req->nlb = secs_per_pg;
+}
+
+static void precondition(struct ssd *ssd, uint64_t span_pgs)
+{
+    int spg = ssd->sp.secs_per_pg;
+    uint32_t chunk = 256 / spg ? 256 / spg : 1;
+    NvmeRequest req;
+
+    for (uint64_t lpn = 0; lpn < span_pgs; lpn += chunk) {
+        uint32_t n = span_pgs - lpn < chunk ? span_pgs - lpn : chunk;
+
+        write_req(&req, lpn, spg);
+        req.nlb = n * spg;
+        ftl_host_submit(ssd, &req, 1);
+    }
+    for (uint64_t i = 0; i < span_pgs; i++) {
+        write_req(&req, bench_rand() % span_pgs, spg);
+        ftl_host_submit(ssd, &req, 1);
+    }
+}
+
+/* 4 KiB random write; with_bg면 ftl_thread처럼 요청 뒤 background GC까지 */
+static void bench_write(struct ssd *ssd, uint64_t span_pgs, uint64_t ops,
+                        bool with_bg, struct bench_row *r)
+{
+    int spg = ssd->sp.secs_per_pg;
+    uint64_t sum = 0, max = 0, t0;
+    NvmeRequest req;
+
+    t0 = now_ns();
+    for (uint64_t i = 0; i < ops; i++) {
+        uint64_t c0, c;
+
+        write_req(&req, bench_rand() % span_pgs, spg);
+        c0 = ftl_host_cycles();
+        ftl_host_io(ssd, &req);
+        if (with_bg) {
+            ftl_host_bg_gc(ssd);
+        }
+        c = ftl_host_cycles() - c0;
+        sum += c;
+        max = c > max ? c : max;
+    }
+
+    r->name = with_bg ? "submit" : "write";
+    r->ops = ops;
+    r->ns_op = (double)(now_ns() - t0) / ops;
+    r->cycles_op = (double)sum / ops;
+    r->max_ns = max * ns_per_cycle;
+}
+
+/*
+ * ring과 요청 사이 처리 비용이 보이도록 4 KiB random read.
+ * poller 쪽에서 BENCH_RING_QD개를 to_ftl ring에 넣고, ftl_thread처럼 ftl_host_poll_ring으로
+ * 모두 처리한 뒤 완료를 to_poller ring에서 꺼냄. 요청당 비용은 ring 왕복 포함,
+ * max는 ftl_host_poll_ring 한 번 (batch 하나) 동안 멈춘 시간.
+ */
+#define BENCH_RING_QD   (64)
+
+static void bench_ring(struct ssd *ssd, uint64_t span_pgs, uint64_t ops,
+                       int batch, struct bench_row *r)
+{
+    struct rte_ring *to_ftl[2] = { NULL, femu_ring_create(FEMU_RING_TYPE_SP_SC, BENCH_RING_QD) };
+    struct rte_ring *to_poller[2] = { NULL, femu_ring_create(FEMU_RING_TYPE_SP_SC, BENCH_RING_QD) };
+    NvmeRequest reqs[BENCH_RING_QD], *ptrs[BENCH_RING_QD];
+    int spg = ssd->sp.secs_per_pg;
+    int batch0 = ssd->ring_batch;
+    uint64_t sum = 0, max = 0, t0, done = 0;
+
+    ssd->to_ftl = to_ftl;
+    ssd->to_poller = to_poller;
+    ssd->ring_batch = batch;
+
+    t0 = now_ns();
+    while (done < ops) {
+        uint64_t c0, c;
+        int qd = ops - done < BENCH_RING_QD ? ops - done : BENCH_RING_QD;
+        int nr = 0;
+
+        for (int k = 0; k < qd; k++) {
+            write_req(&reqs[k], bench_rand() % span_pgs, spg);
+            reqs[k].cmd.opcode = NVME_CMD_READ;
+            ptrs[k] = &reqs[k];
+        }
+        femu_ring_enqueue(to_ftl[1], (void **)ptrs, qd);
+
+        c0 = ftl_host_cycles();
+        while (nr < qd) {
+            int n = ftl_host_poll_ring(ssd, 1);
+
+            c = ftl_host_cycles() - c0;
+            max = c > max ? c : max;
+            sum += c;
+            nr += n;
+            c0 = ftl_host_cycles();
+        }
+        femu_ring_dequeue(to_poller[1], (void **)ptrs, qd);
+        done += qd;
+    }
+
+    r->name = batch > 1 ? "ring" : "ring1";
+    r->ops = ops;
+    r->ns_op = (double)(now_ns() - t0) / ops;
+    r->cycles_op = (double)sum / ops;
+    r->max_ns = max * ns_per_cycle;
+
+    ssd->ring_batch = batch0;
+    ssd->to_ftl = NULL;
+    ssd->to_poller = NULL;
+    femu_ring_free(to_ftl[1]);
+    femu_ring_free(to_poller[1]);
+}
+
+/*
+ * victim 선택 + 라인 GC. do_gc()와 같은 순서로 풀을 고르고, 모든 풀에 victim이
+ * 없으면 force로 다시 시도. 각 GC 뒤에는 라인 하나 분량의 random write로
+ * 풀을 다시 채워 victim 자료구조가 steady state 크기를 유지하도록 함.
+ *
+ * 기본 GC threshold에서는 ssd_write의 GC(foreground/pacing)가 victim을 모두
+ * 치워버리므로, 이 구간에서는 threshold를 0으로 내려 invalid page가 쌓이게 함.
+ * emergency GC 경로까지 가지 않도록 어느 풀이든 free line이 BENCH_MIN_FREE
+ * 이하가 되면 쓰기를 멈춤.
+ */
+#define BENCH_MIN_FREE  (2)
+
+static void fill_random(struct ssd *ssd, uint64_t span_pgs, uint64_t pgs)
+{
+    struct line_mgmt *lm = &ssd->lm;
+    int spg = ssd->sp.secs_per_pg;
+    NvmeRequest req;
+
+    for (uint64_t j = 0; j < pgs; j++) {
+        for (int c = 0; c < lm->nr_pools; c++) {
+            if (lm->pool[c].free_cnt <= BENCH_MIN_FREE) {
+                return;
+            }
+        }
+        write_req(&req, bench_rand() % span_pgs, spg);
+        ftl_host_io(ssd, &req);
+    }
+}
+
+static void bench_gc(struct ssd *ssd, uint64_t span_pgs, int nr,
+                     struct bench_row *sel, struct bench_row *gc)
+{
+    uint64_t sel_sum = 0, sel_max = 0, gc_sum = 0, gc_max = 0;
+    uint64_t nsel = 0, moved = 0, ngc = 0;
+    int thres = ssd->sp.gc_thres_lines, thres_high = ssd->sp.gc_thres_lines_high;
+
+    ssd->sp.gc_thres_lines = 0;
+    ssd->sp.gc_thres_lines_high = 0;
+    fill_random(ssd, span_pgs, span_pgs / 2);
+
+    for (int i = 0; i < nr; i++) {
+        struct ftl_host_gc_sample s;
+        int order[FTL_MAX_TEMPS];
+        int npools = ftl_host_gc_pool_order(ssd, order);
+        bool done = false;
+
+        for (int force = 0; force <= 1 && !done; force++) {
+            for (int k = 0; k < npools && !done; k++) {
+                done = ftl_host_gc_once(ssd, order[k], force, &s);
+                sel_sum += s.sel_cycles;
+                sel_max = s.sel_cycles > sel_max ? s.sel_cycles : sel_max;
+                nsel++;
+            }
+        }
+        if (!done) {
+            break;
+        }
+        gc_sum += s.gc_cycles;
+        gc_max = s.gc_cycles > gc_max ? s.gc_cycles : gc_max;
+        moved += s.moved;
+        ngc++;
+
+        fill_random(ssd, span_pgs, ssd->sp.pgs_per_line);
+    }
+
+    ssd->sp.gc_thres_lines = thres;
+    ssd->sp.gc_thres_lines_high = thres_high;
+
+    sel->name = "victim_sel";
+    sel->ops = nsel;
+    sel->cycles_op = nsel ? (double)sel_sum / nsel : 0;
+    sel->ns_op = sel->cycles_op * ns_per_cycle;
+    sel->max_ns = sel_max * ns_per_cycle;
+
+    /* gc_page: 옮긴 페이지당 비용, max는 라인 하나 GC 전체 시간 */
+    gc->name = "gc_page";
+    gc->ops = moved;
+    gc->cycles_op = moved ? (double)gc_sum / moved : 0;
+    gc->ns_op = gc->cycles_op * ns_per_cycle;
+    gc->max_ns = gc_max * ns_per_cycle;
+    if (ngc == 0) {
+        fprintf(stderr, "ftl_bench: no GC victims found\n");
+    }
+}
+
+/*
+ * decay epoch 경계 처리 비용. host_writes를 window/64 씩 밀어 64번에 한 번
+ * epoch이 넘어가게 함 (host_writes를 건드리므로 geometry마다 마지막에 실행).
+ */
+static void bench_decay(struct ssd *ssd, uint64_t ops, struct bench_row *r)
+{
+    uint64_t step = ssd->hot_cold_decay_window / 64 ? ssd->hot_cold_decay_window / 64 : 1;
+    uint64_t sum = 0, max = 0, t0;
+
+    t0 = now_ns();
+    for (uint64_t i = 0; i < ops; i++) {
+        uint64_t c0, c;
+
+        ssd->host_writes += step;
+        c0 = ftl_host_cycles();
+        ftl_maybe_decay_lpn_stats(ssd);
+        c = ftl_host_cycles() - c0;
+        sum += c;
+        max = c > max ? c : max;
+    }
+
+    r->name = "decay";
+    r->ops = ops;
+    r->ns_op = (double)(now_ns() - t0) / ops;
+    r->cycles_op = (double)sum / ops;
+    r->max_ns = max * ns_per_cycle;
+}
+
+#define BENCH_IDLE_ROUNDS   (200)
+#define BENCH_IDLE_CPU_MS   (200)
+#define BENCH_IDLE_SLEEP_US (100)   /* sleep 단계는 기본으로 꺼져 있으므로 sleep 행에서만 켬 */
+
+/*
+ * ring이 gap_ns 동안 비어 있게 둔 뒤 read 하나를 넣고 완료가 돌아올 때까지 기다림.
+ * poller 쪽은 sched_yield로 기다리므로 CPU가 하나뿐이어도 FTL 스레드가 돌 수 있음
+ * (그래도 그때 wake_spin/wake_yield는 scheduler time slice에 묶임).
+ */
+static void bench_wake(FemuCtrl *n, const char *name, int64_t gap_ns, bool kick,
+                       uint64_t span_pgs, struct bench_row *r)
+{
+    int spg = n->ssd->sp.secs_per_pg;
+    uint64_t sum = 0, max = 0;
+    NvmeRequest req;
+
+    for (int i = 0; i < BENCH_IDLE_ROUNDS; i++) {
+        void *p = &req;
+        uint64_t t0, t;
+
+        if (gap_ns >= 1000000) {
+            usleep(gap_ns / 1000);
+        } else {
+            for (t0 = now_ns(); now_ns() - t0 < (uint64_t)gap_ns; ) {
+                sched_yield();
+            }
+        }
+        write_req(&req, bench_rand() % span_pgs, spg);
+        req.cmd.opcode = NVME_CMD_READ;
+
+        t0 = now_ns();
+        femu_ring_enqueue(n->to_ftl[1], &p, 1);
+        if (kick) {
+            ftl_kick(n->ssd);
+        }
+        while (femu_ring_dequeue(n->to_poller[1], &p, 1) != 1) {
+            sched_yield();
+        }
+        t = now_ns() - t0;
+        sum += t;
+        max = t > max ? t : max;
+    }
+
+    r->name = name;
+    r->ops = BENCH_IDLE_ROUNDS;
+    r->ns_op = (double)sum / BENCH_IDLE_ROUNDS;
+    r->cycles_op = r->ns_op / ns_per_cycle;
+    r->max_ns = max;
+}
+
+/* ring이 빈 채로 BENCH_IDLE_CPU_MS 동안 FTL 스레드가 쓴 CPU 시간 */
+static void bench_idle_cpu(FemuCtrl *n, const char *name, bool backoff,
+                           struct bench_row *r)
+{
+    struct timespec a, b;
+    clockid_t cid;
+
+    __atomic_store_n(&n->ssd->idle_backoff, backoff, __ATOMIC_RELAXED);
+    pthread_getcpuclockid(n->ssd->ftl_thread.thread, &cid);
+    clock_gettime(cid, &a);
+    usleep(BENCH_IDLE_CPU_MS * 1000);
+    clock_gettime(cid, &b);
+    __atomic_store_n(&n->ssd->idle_backoff, true, __ATOMIC_RELAXED);
+
+    r->name = name;
+    r->ops = BENCH_IDLE_CPU_MS;
+    r->ns_op = ((b.tv_sec - a.tv_sec) * 1e9 + (b.tv_nsec - a.tv_nsec)) / BENCH_IDLE_CPU_MS;
+    r->cycles_op = r->ns_op / ns_per_cycle;
+    r->max_ns = 0;
+}
+
+/* ftl_thread를 실제로 띄움: 이 ssd는 이후 FTL 스레드 소유이고 스레드는 끝나지 않음 */
+static void run_idle(struct bench_opts *o)
+{
+    BbCtrlParams bp;
+    struct bench_row r;
+    FemuCtrl *n;
+    struct ssd *ssd;
+    uint64_t span_pgs;
+
+    ftl_host_default_params(&bp);
+    bp.nchs = o->nchs;
+    bp.luns_per_ch = o->luns[0];
+    bp.blks_per_pl = o->lines[0];
+    bp.pgs_per_blk = o->pgs[0];
+
+    n = ftl_host_create(&bp);
+    ssd = n->ssd;
+    span_pgs = (uint64_t)(ssd->sp.tt_pgs * o->span);
+    precondition(ssd, span_pgs);
+
+    n->nr_pollers = 1;
+    n->to_ftl = g_malloc0(sizeof(struct rte_ring *) * 2);
+    n->to_poller = g_malloc0(sizeof(struct rte_ring *) * 2);
+    n->to_ftl[1] = femu_ring_create(FEMU_RING_TYPE_SP_SC, FTL_RING_BATCH_MAX);
+    n->to_poller[1] = femu_ring_create(FEMU_RING_TYPE_SP_SC, FTL_RING_BATCH_MAX);
+    __atomic_store_n(&n->dataplane_started, true, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&ssd->to_ftl, __ATOMIC_ACQUIRE)) {
+        usleep(1000);
+    }
+
+    bench_idle_cpu(n, "idle_spin", false, &r);
+    emit(&bp, &r);
+    bench_idle_cpu(n, "idle_cpu", true, &r);
+    emit(&bp, &r);
+    bench_wake(n, "wake_spin", 0, true, span_pgs, &r);
+    emit(&bp, &r);
+    bench_wake(n, "wake_yield", (ssd->idle_spin_ns + ssd->idle_yield_ns) / 2, true,
+               span_pgs, &r);
+    emit(&bp, &r);
+    __atomic_store_n(&ssd->idle_sleep_ns, BENCH_IDLE_SLEEP_US * 1000LL, __ATOMIC_RELAXED);
+    bench_idle_cpu(n, "idle_sleep", true, &r);
+    emit(&bp, &r);
+    bench_wake(n, "wake_sleep", ssd->idle_yield_ns + 2000000, true, span_pgs, &r);
+    emit(&bp, &r);
+    bench_wake(n, "wake_nokick", ssd->idle_yield_ns + 2000000, false, span_pgs, &r);
+    emit(&bp, &r);
+}
+
+static void run_geometry(struct bench_opts *o, int lines, int luns, int pgs)
+{
+    BbCtrlParams bp;
+    struct bench_row r[2];
+    struct ssd *ssd;
+    uint64_t span_pgs, ops;
+
+    ftl_host_default_params(&bp);
+    bp.nchs = o->nchs;
+    bp.luns_per_ch = luns;
+    bp.blks_per_pl = lines;
+    bp.pgs_per_blk = pgs;
+
+    ssd = ftl_host_create(&bp)->ssd;
+    span_pgs = (uint64_t)(ssd->sp.tt_pgs * o->span);
+    ops = o->ops ? o->ops : span_pgs;
+
+    precondition(ssd, span_pgs);
+
+    bench_write(ssd, span_pgs, ops, false, &r[0]);
+    emit(&bp, &r[0]);
+    bench_write(ssd, span_pgs, ops, true, &r[0]);
+    emit(&bp, &r[0]);
+    bench_ring(ssd, span_pgs, ops, 1, &r[0]);
+    emit(&bp, &r[0]);
+    bench_ring(ssd, span_pgs, ops, ssd->ring_batch, &r[0]);
+    emit(&bp, &r[0]);
+    bench_gc(ssd, span_pgs, o->gc_lines, &r[0], &r[1]);
+    emit(&bp, &r[0]);
+    emit(&bp, &r[1]);
+    bench_decay(ssd, ops, &r[0]);
+    emit(&bp, &r[0]);
+}
+
+int main(int argc, char **argv)
+{
+    struct bench_opts o;
+
+    parse_opts(&o, argc, argv);
+
+    if (o.json) {
+        json_fp = strcmp(o.json, "-") ? fopen(o.json, "w") : stdout;
+        if (!json_fp) {
+            fprintf(stderr, "cannot open %s: %s\n", o.json, strerror(errno));
+            exit(1);
+        }
+    }
+
+    femu_stub_set_clock(0);
+    calibrate();
+    rng_state = o.seed ? o.seed : 1;
+
+    for (int i = 0; i < o.nr_lines; i++) {
+        for (int j = 0; j < o.nr_luns; j++) {
+            for (int k = 0; k < o.nr_pgs; k++) {
+                run_geometry(&o, o.lines[i], o.luns[j], o.pgs[k]);
+            }
+        }
+    }
+    if (o.idle) {
+        run_idle(&o);
+    }
+
+    if (json_fp && json_fp != stdout) {
+        fclose(json_fp);
+    }
+
+    return 0;
+}
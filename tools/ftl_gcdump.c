@@ -0,0 +1,134 @@
+/*
+ * ftl_gcdump: prints a GC event log recorded with FEMU_FTL_GC_LOG.
+ *
+ *   ftl_gcdump gc.bin            한 줄에 event 하나 (CSV) + 마지막에 요약
+ *   ftl_gcdump --summary gc.bin  요약만
+ */
+#include <errno.h>
+#include <getopt.h>
+
+#include "ftl.h"
+
+struct gc_summary {
+    uint64_t n;
+    uint64_t forced;
+    uint64_t emergency;
+    uint64_t wl;
+    uint64_t incr;
+    uint64_t idle;
+    uint64_t moved;
+    uint64_t cpu_ns;
+    int64_t emu_ns;
+};
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [--summary] GCLOG\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option longopts[] = {
+        { "summary", no_argument, NULL, 's' },
+        { "help",    no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    struct gc_summary sum[FTL_MAX_TEMPS] = { { 0 } };
+    uint8_t hdr[FTL_GCLOG_HDR_SZ];
+    struct gc_event ev;
+    bool summary_only = false;
+    uint32_t ver, rec_sz;
+    int64_t first = -1;
+    int nr_temps = 2;
+    FILE *fp;
+    int c;
+
+    while ((c = getopt_long(argc, argv, "sh", longopts, NULL)) != -1) {
+        switch (c) {
+        case 's': summary_only = true; break;
+        case 'h':
+        default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    fp = fopen(argv[optind], "rb");
+    if (!fp) {
+        fprintf(stderr, "cannot open %s: %s\n", argv[optind], strerror(errno));
+        return 1;
+    }
+    if (fread(hdr, 1, sizeof(hdr), fp) != sizeof(hdr) ||
+        memcmp(hdr, FTL_GCLOG_MAGIC, 8)) {
+        fprintf(stderr, "%s: not a GC event log\n", argv[optind]);
+        return 1;
+    }
+    memcpy(&ver, hdr + 8, 4);
+    memcpy(&rec_sz, hdr + 12, 4);
+    if (ver != FTL_GCLOG_VERSION || rec_sz != sizeof(struct gc_event)) {
+        fprintf(stderr, "%s: unsupported version %u / record size %u\n",
+                argv[optind], ver, rec_sz);
+        return 1;
+    }
+
+    if (!summary_only) {
+        printf("time_us,pool,line,ipc,vpc,moved,emu_us,cpu_us,force,emergency,wl,incr,idle\n");
+    }
+    while (fread(&ev, sizeof(ev), 1, fp) == 1) {
+        struct gc_summary *s;
+
+        if (ev.cls >= FTL_MAX_TEMPS) {
+            fprintf(stderr, "%s: bad pool %u\n", argv[optind], ev.cls);
+            return 1;
+        }
+        s = &sum[ev.cls];
+        if (first < 0) {
+            first = ev.stime;
+            nr_temps = ev.nr_temps;
+        }
+        s->n++;
+        s->forced += !!(ev.flags & GC_EV_FORCE);
+        s->emergency += !!(ev.flags & GC_EV_EMERGENCY);
+        s->wl += !!(ev.flags & GC_EV_WL);
+        s->incr += !!(ev.flags & GC_EV_INCR);
+        s->idle += !!(ev.flags & GC_EV_IDLE);
+        s->moved += ev.moved;
+        s->cpu_ns += ev.cpu_ns;
+        s->emu_ns += ev.emu_ns;
+
+        if (!summary_only) {
+            printf("%.3f,%s,%u,%u,%u,%u,%.3f,%.3f,%d,%d,%d,%d,%d\n",
+                   (ev.stime - first) / 1e3,
+                   ftl_temp_name(ev.nr_temps, ev.cls),
+                   ev.line, ev.ipc, ev.vpc, ev.moved,
+                   ev.emu_ns / 1e3, ev.cpu_ns / 1e3,
+                   !!(ev.flags & GC_EV_FORCE), !!(ev.flags & GC_EV_EMERGENCY),
+                   !!(ev.flags & GC_EV_WL), !!(ev.flags & GC_EV_INCR),
+                   !!(ev.flags & GC_EV_IDLE));
+        }
+    }
+    fclose(fp);
+
+    for (int i = FTL_MAX_TEMPS - 1; i >= 0; i--) {
+        struct gc_summary *s = &sum[i];
+
+        if (!s->n) {
+            continue;
+        }
+        fprintf(summary_only ? stdout : stderr,
+                "ftl_gcdump: %-4s %" PRIu64 " GCs (forced %" PRIu64
+                ", emergency %" PRIu64 ", wear-leveling %" PRIu64
+                ", incremental %" PRIu64 ", idle %" PRIu64 "), avg moved %.1f pages, "
+                "avg emu %.1f us, avg cpu %.1f us\n",
+                ftl_temp_name(nr_temps, i), s->n, s->forced, s->emergency,
+                s->wl, s->incr, s->idle,
+                (double)s->moved / s->n, s->emu_ns / 1e3 / s->n,
+                s->cpu_ns / 1e3 / s->n);
+    }
+
+    return 0;
+}
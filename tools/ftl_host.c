@@ -0,0 +1,179 @@
+/*
+ * Compiles the FTL source as-is (unity build) so its static functions can be
+ * wrapped for host-side tools.
+ */
+#include "../ftl _hc_v4.c"
+
+#include "ftl_host.h"
+
+void ftl_host_default_params(BbCtrlParams *bp)
+{
+    memset(bp, 0, sizeof(*bp));
+
+    bp->secsz = 512;
+    bp->secs_per_pg = 8;
+    bp->pgs_per_blk = 256;
+    bp->blks_per_pl = 256;
+    bp->pls_per_lun = 1;
+    bp->luns_per_ch = 8;
+    bp->nchs = 8;
+
+    bp->pg_rd_lat = NAND_READ_LATENCY;
+    bp->pg_wr_lat = NAND_PROG_LATENCY;
+    bp->blk_er_lat = NAND_ERASE_LATENCY;
+    bp->ch_xfer_lat = 0;
+
+    bp->gc_thres_pcent = 20;
+    bp->gc_thres_pcent_high = 5;
+}
+
+FemuCtrl *ftl_host_create(const BbCtrlParams *bp)
+{
+    FemuCtrl *n;
+    struct ssd *ssd;
+
+    /* 둘 다 free line 비율이므로 foreground(high)가 background보다 낮아야 함 */
+    if (bp->gc_thres_pcent_high >= bp->gc_thres_pcent) {
+        fprintf(stderr, "invalid --gc-thres-high %d: must be below --gc-thres %d\n",
+                bp->gc_thres_pcent_high, bp->gc_thres_pcent);
+        exit(1);
+    }
+
+    n = g_malloc0(sizeof(FemuCtrl));
+    ssd = g_malloc0(sizeof(struct ssd));
+
+    n->devname = "ftl-host";
+    n->bb_params = *bp;
+    n->ssd = ssd;
+
+    ssd->ssdname = n->devname;
+    ssd->dataplane_started_ptr = &n->dataplane_started;
+
+    ssd_init(n);
+
+    return n;
+}
+
+uint64_t ftl_host_io(struct ssd *ssd, NvmeRequest *req)
+{
+    switch (req->cmd.opcode) {
+    case NVME_CMD_WRITE:
+        return ssd_write(ssd, req);
+    case NVME_CMD_READ:
+        return ssd_read(ssd, req);
+    case NVME_CMD_DSM:
+        if (req->dsm_ranges && req->dsm_nr_ranges > 0) {
+            return ssd_trim(ssd, req);
+        }
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+bool ftl_host_bg_gc(struct ssd *ssd)
+{
+    bool ret = gc_background_step(ssd, 1);
+
+    wear_level_static(ssd);
+    return ret;
+}
+
+/*
+ * 가상 clock에서는 ring이 비는 순간이 따로 없으므로, 직전 요청과 이번 요청(now) 사이에서
+ * ftl_thread가 idle GC를 돌렸을 시점을 흉내냄: NAND가 다시 쉬게 되는 시각마다 step 하나.
+ */
+static void ftl_host_idle_gc(struct ssd *ssd, int64_t now)
+{
+    int64_t t = ssd->last_req_ns + IDLE_GC_DELAY_NS;
+
+    for (;;) {
+        int64_t idle = nand_idle_at(ssd);
+
+        t = idle > t ? idle : t;
+        if (t >= now) {
+            break;
+        }
+        femu_stub_set_clock(t);
+        if (!gc_idle_step(ssd, t)) {
+            break;
+        }
+    }
+    femu_stub_set_clock(now);
+}
+
+uint64_t ftl_host_submit(struct ssd *ssd, NvmeRequest *req, int poller)
+{
+    uint64_t lat;
+    int prof;
+
+    /* 요청 사이 (generator, trace 읽기) 시간은 profiler에서 idle로 잡힘 */
+    ftl_prof_tick(ssd);
+    prof = prof_enter(ssd, PROF_OTHER);
+    if (ssd->idle_gc_lines) {
+        ftl_host_idle_gc(ssd, req->stime);
+    }
+    ssd->last_req_ns = req->stime;
+    ssd->req_gc_stalled = false;
+    if (ssd->trace) {
+        ftl_trace_record(ssd, req, poller);
+    }
+    prof_switch(ssd, req->cmd.opcode == NVME_CMD_WRITE ? PROF_WRITE :
+                     req->cmd.opcode == NVME_CMD_READ ? PROF_READ : PROF_TRIM);
+    lat = ftl_host_io(ssd, req);
+    prof_switch(ssd, PROF_OTHER);
+    ftl_lat_record(ssd, req, lat);
+    ftl_stats_update(ssd, req->stime);
+    ftl_host_bg_gc(ssd);
+    prof_leave(ssd, prof);
+
+    return lat;
+}
+
+int ftl_host_poll_ring(struct ssd *ssd, int poller)
+{
+    return ftl_poll_ring(ssd, poller);
+}
+
+int ftl_host_gc_pool_order(struct ssd *ssd, int *order)
+{
+    return gc_pool_order(ssd, order);
+}
+
+bool ftl_host_gc_once(struct ssd *ssd, int cls, bool force,
+                      struct ftl_host_gc_sample *s)
+{
+    uint64_t t0, t1;
+    struct line *victim;
+
+    t0 = ftl_host_cycles();
+    victim = select_victim_line_pool(ssd, cls, force);
+    t1 = ftl_host_cycles();
+    s->sel_cycles = t1 - t0;
+    s->gc_cycles = 0;
+    s->moved = 0;
+    if (!victim) {
+        return false;
+    }
+
+    s->moved = victim->vpc;
+    do_gc_for_line(ssd, victim, 0);
+    s->gc_cycles = ftl_host_cycles() - t1;
+
+    return true;
+}
+
+bool ftl_host_geom_opt(BbCtrlParams *bp, int c, const char *arg)
+{
+    switch (c) {
+    case 0x100: bp->nchs = atoi(arg); break;
+    case 0x101: bp->luns_per_ch = atoi(arg); break;
+    case 0x102: bp->blks_per_pl = atoi(arg); break;
+    case 0x103: bp->pgs_per_blk = atoi(arg); break;
+    case 0x104: bp->gc_thres_pcent = atoi(arg); break;
+    case 0x105: bp->gc_thres_pcent_high = atoi(arg); break;
+    default:
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+/*
+ * Host-side access to the FTL: builds a struct ssd without QEMU and exposes
+ * the static I/O entry points of ftl.c (ssd_write/ssd_read/ssd_trim) so that
+ * simulators and benchmarks can drive them directly.
+ */
+#ifndef __FTL_HOST_H
+#define __FTL_HOST_H
+
+#include <getopt.h>
+
+#include "ftl.h"
+
+/* FEMU bbssd 기본값 (16 GiB, 8ch x 8lun x 256blk x 256pg) */
+void ftl_host_default_params(BbCtrlParams *bp);
+
+/* FemuCtrl + struct ssd 할당 후 ssd_init(); FTL 스레드는 dataplane 시작 전까지 대기 */
+FemuCtrl *ftl_host_create(const BbCtrlParams *bp);
+
+/*
+ * ftl_thread()가 ring에서 꺼낸 요청 하나를 처리하는 것과 같은 경로
+ * (trace 기록 + opcode dispatch + background GC). 반환값은 emulated latency (ns).
+ */
+uint64_t ftl_host_submit(struct ssd *ssd, NvmeRequest *req, int poller);
+
+/*
+ * ftl_thread()가 poller ring 하나를 한 번 처리하는 것 (ring_batch개까지 꺼내 처리, 완료는 한 번에
+ * enqueue, background GC는 batch마다). ssd->to_ftl/to_poller가 있어야 함. 처리한 요청 수 반환.
+ */
+int ftl_host_poll_ring(struct ssd *ssd, int poller);
+
+/* ===== microbenchmark용: ftl_host_submit을 단계별로 ===== */
+
+/* opcode dispatch만 (ssd_write/ssd_read/ssd_trim) */
+uint64_t ftl_host_io(struct ssd *ssd, NvmeRequest *req);
+
+/* ftl_thread의 요청 후 background GC 한 번 (should_gc일 때); GC를 했으면 true */
+bool ftl_host_bg_gc(struct ssd *ssd);
+
+struct ftl_host_gc_sample {
+    uint64_t sel_cycles;    /* select_victim_line_*() */
+    uint64_t gc_cycles;     /* do_gc_for_line() */
+    int moved;              /* 옮긴 valid page 수 */
+};
+
+/* do_gc()가 victim을 찾아보는 pool 순서 (order[FTL_MAX_TEMPS]), pool 수 반환 */
+int ftl_host_gc_pool_order(struct ssd *ssd, int *order);
+
+/* 지정한 풀에서 victim 선택 + do_gc_for_line(); victim이 없으면 false (sel_cycles만 유효) */
+bool ftl_host_gc_once(struct ssd *ssd, int cls, bool force,
+                      struct ftl_host_gc_sample *s);
+
+/* TSC (x86) 또는 ns 단위 카운터 (FTL profiler와 같은 것) */
+static inline uint64_t ftl_host_cycles(void)
+{
+    return ftl_cycles();
+}
+
+/* 도구들이 공유하는 geometry / GC 옵션 (getopt_long) */
+#define FTL_HOST_GEOM_OPTS                                      \
+    { "nchs",           required_argument, NULL, 0x100 },       \
+    { "luns",           required_argument, NULL, 0x101 },       \
+    { "blks",           required_argument, NULL, 0x102 },       \
+    { "pgs",            required_argument, NULL, 0x103 },       \
+    { "gc-thres",       required_argument, NULL, 0x104 },       \
+    { "gc-thres-high",  required_argument, NULL, 0x105 }
+
+#define FTL_HOST_GEOM_USAGE                                                   \
+    "geometry:\n"                                                             \
+    "  --nchs N            channels (default 8)\n"                            \
+    "  --luns N            LUNs per channel (default 8)\n"                    \
+    "  --blks N            blocks per plane = lines (default 256)\n"          \
+    "  --pgs N             pages per block (default 256)\n"                   \
+    "  --gc-thres P        background GC threshold, %% free lines (default 20)\n" \
+    "  --gc-thres-high P   foreground GC threshold, %% free lines (default 5)\n"
+
+/* FTL_HOST_GEOM_OPTS 중 하나면 bp에 반영하고 true */
+bool ftl_host_geom_opt(BbCtrlParams *bp, int c, const char *arg);
+
+#endif
@@ -0,0 +1,296 @@
+/*
+ * ftl_replay: replays a binary trace recorded by ftl_thread (FEMU_FTL_TRACE)
+ * through the same ssd_* entry points.
+ *
+ *   --mode orig   가상 clock을 기록된 stime 간격 그대로 진행 (idle 구간 포함)
+ *   --mode afap   기록된 간격 무시, 이전 요청이 끝나는 시점에 다음 요청 제출
+ *
+ * 어느 쪽이든 실제 시간으로는 기다리지 않으므로 재생 자체는 최대 속도로 돈다.
+ */
+#include <errno.h>
+
+#include "ftl_host.h"
+
+enum {
+    MODE_ORIG = 0,
+    MODE_AFAP = 1,
+};
+
+struct replay_opts {
+    BbCtrlParams bp;
+    const char *path;
+    int mode;
+    uint64_t limit;         /* 0이면 끝까지 */
+    uint64_t report;
+    bool lun_stats;
+    bool wear_stats;
+};
+
+struct trace_reader {
+    FILE *fp;
+    const char *path;
+    int64_t stime;
+    uint64_t lba;
+};
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options] TRACE\n"
+            FTL_HOST_GEOM_USAGE
+            "replay:\n"
+            "  --mode orig|afap    recorded inter-arrival or back-to-back (default orig)\n"
+            "  --limit N           stop after N requests\n"
+            "  --report N          print WAF statistics every N requests\n"
+            "  --lun-stats         also print per-LUN utilization at the end\n"
+            "  --wear-stats        also print the line erase-count distribution\n",
+            prog);
+}
+
+static void parse_opts(struct replay_opts *o, int argc, char **argv)
+{
+    static const struct option longopts[] = {
+        FTL_HOST_GEOM_OPTS,
+        { "mode",   required_argument, NULL, 'm' },
+        { "limit",  required_argument, NULL, 'n' },
+        { "report", required_argument, NULL, 'R' },
+        { "lun-stats", no_argument,    NULL, 'L' },
+        { "wear-stats", no_argument,   NULL, 'E' },
+        { "help",   no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int c;
+
+    ftl_host_default_params(&o->bp);
+    o->mode = MODE_ORIG;
+    o->limit = 0;
+    o->report = 0;
+    o->lun_stats = false;
+    o->wear_stats = false;
+
+    while ((c = getopt_long(argc, argv, "h", longopts, NULL)) != -1) {
+        if (ftl_host_geom_opt(&o->bp, c, optarg)) {
+            continue;
+        }
+        switch (c) {
+        case 'm':
+            if (!strcmp(optarg, "orig")) {
+                o->mode = MODE_ORIG;
+            } else if (!strcmp(optarg, "afap")) {
+                o->mode = MODE_AFAP;
+            } else {
+                fprintf(stderr, "unknown mode: %s\n", optarg);
+                exit(1);
+            }
+            break;
+        case 'n': o->limit = strtoull(optarg, NULL, 0); break;
+        case 'R': o->report = strtoull(optarg, NULL, 0); break;
+        case 'L': o->lun_stats = true; break;
+        case 'E': o->wear_stats = true; break;
+        case 'h':
+        default:
+            usage(argv[0]);
+            exit(c == 'h' ? 0 : 1);
+        }
+    }
+
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        exit(1);
+    }
+    o->path = argv[optind];
+}
+
+static void trace_corrupt(struct trace_reader *r)
+{
+    fprintf(stderr, "%s: truncated or corrupt record at offset %ld\n",
+            r->path, ftell(r->fp));
+    exit(1);
+}
+
+static uint64_t get_varint(struct trace_reader *r)
+{
+    uint64_t v = 0;
+    int shift = 0;
+    int c;
+
+    do {
+        c = getc_unlocked(r->fp);
+        if (c == EOF || shift > 63) {
+            trace_corrupt(r);
+        }
+        v |= (uint64_t)(c & 0x7f) << shift;
+        shift += 7;
+    } while (c & 0x80);
+
+    return v;
+}
+
+static int64_t get_zigzag(struct trace_reader *r)
+{
+    uint64_t v = get_varint(r);
+
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static void trace_open(struct trace_reader *r, const char *path,
+                       struct ssd *ssd)
+{
+    uint8_t hdr[FTL_TRACE_HDR_SZ];
+    uint32_t ver, spg;
+
+    memset(r, 0, sizeof(*r));
+    r->path = path;
+    r->fp = fopen(path, "rb");
+    if (!r->fp) {
+        fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+        exit(1);
+    }
+    if (fread(hdr, 1, sizeof(hdr), r->fp) != sizeof(hdr) ||
+        memcmp(hdr, FTL_TRACE_MAGIC, 8)) {
+        fprintf(stderr, "%s: not an FTL trace\n", path);
+        exit(1);
+    }
+    memcpy(&ver, hdr + 8, 4);
+    memcpy(&spg, hdr + 12, 4);
+    if (ver != FTL_TRACE_VERSION) {
+        fprintf(stderr, "%s: unsupported trace version %u\n", path, ver);
+        exit(1);
+    }
+    if (spg != (uint32_t)ssd->sp.secs_per_pg) {
+        fprintf(stderr, "%s: warning: recorded with %u sectors/page, "
+                "replaying with %d\n", path, spg, ssd->sp.secs_per_pg);
+    }
+}
+
+/* record 하나를 req로 복원; EOF면 false. DSM range는 g_malloc (ssd_trim이 해제) */
+static bool trace_next(struct trace_reader *r, NvmeRequest *req, int *poller)
+{
+    int tag = getc_unlocked(r->fp);
+    int op;
+
+    if (tag == EOF) {
+        return false;
+    }
+
+    memset(req, 0, sizeof(*req));
+    op = tag & 3;
+    *poller = tag >> 2;
+    if (*poller == FTL_TRACE_POLLER_ESC) {
+        *poller = get_varint(r);
+    }
+    r->stime += get_zigzag(r);
+    req->stime = r->stime;
+
+    switch (op) {
+    case FTL_TRACE_OP_WRITE:
+    case FTL_TRACE_OP_READ:
+        req->cmd.opcode = op == FTL_TRACE_OP_WRITE ? NVME_CMD_WRITE
+                                                   : NVME_CMD_READ;
+        req->slba = r->lba + get_zigzag(r);
+        req->nlb = get_varint(r);
+        r->lba = req->slba + req->nlb;
+        break;
+    case FTL_TRACE_OP_DSM:
+        req->cmd.opcode = NVME_CMD_DSM;
+        req->dsm_nr_ranges = get_varint(r);
+        req->dsm_attributes = get_varint(r);
+        if (req->dsm_nr_ranges > 256) {
+            trace_corrupt(r);
+        }
+        req->dsm_ranges = g_malloc0(sizeof(NvmeDsmRange) *
+                                    (req->dsm_nr_ranges ? req->dsm_nr_ranges : 1));
+        for (uint32_t i = 0; i < req->dsm_nr_ranges; i++) {
+            req->dsm_ranges[i].slba = r->lba + get_zigzag(r);
+            req->dsm_ranges[i].nlb = get_varint(r);
+            r->lba = req->dsm_ranges[i].slba + req->dsm_ranges[i].nlb;
+        }
+        break;
+    default:
+        trace_corrupt(r);
+    }
+
+    return true;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    static const char *opname[3] = { "write", "read", "trim" };
+    uint64_t reqs[3] = { 0 };
+    struct replay_opts o;
+    struct trace_reader r;
+    struct ssd *ssd;
+    NvmeRequest req;
+    int64_t base = -1, now = 0;
+    uint64_t nreq = 0;
+    int poller;
+    double t0, el;
+
+    parse_opts(&o, argc, argv);
+
+    femu_stub_set_clock(0);
+    ssd = ftl_host_create(&o.bp)->ssd;
+    trace_open(&r, o.path, ssd);
+
+    t0 = now_sec();
+    while ((!o.limit || nreq < o.limit) && trace_next(&r, &req, &poller)) {
+        int k = req.cmd.opcode == NVME_CMD_WRITE ? 0 :
+                req.cmd.opcode == NVME_CMD_READ ? 1 : 2;
+        uint64_t lat;
+
+        if (o.mode == MODE_ORIG) {
+            /* 첫 요청을 가상 시간 0으로 맞추고 기록된 간격 유지 */
+            if (base < 0) {
+                base = req.stime;
+            }
+            now = req.stime - base;
+        }
+        req.stime = now;
+        femu_stub_set_clock(now);
+
+        lat = ftl_host_submit(ssd, &req, poller);
+        reqs[k]++;
+
+        if (o.mode == MODE_AFAP) {
+            now += lat;
+        }
+        nreq++;
+        if (o.report && nreq % o.report == 0) {
+            print_waf_stats(ssd);
+        }
+    }
+    el = now_sec() - t0;
+    fclose(r.fp);
+
+    ftl_trace_close(ssd);
+    ftl_gclog_close(ssd);
+    ftl_stats_close(ssd);
+    print_waf_stats(ssd);
+    ftl_print_prof(ssd);
+    if (o.lun_stats) {
+        ftl_print_lun_stats(ssd);
+    }
+    if (o.wear_stats) {
+        ftl_print_wear_stats(ssd);
+    }
+    ftl_print_lat_stats(ssd);
+
+    printf("ftl_replay: %" PRIu64 " requests in %.3f s (%.2f Mreq/s), "
+           "virtual time %.3f s\n",
+           nreq, el, el > 0 ? nreq / el / 1e6 : 0.0, now / 1e9);
+    for (int i = 0; i < 3; i++) {
+        if (reqs[i]) {
+            printf("ftl_replay: %-5s %" PRIu64 " reqs\n", opname[i], reqs[i]);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,392 @@
+/*
+ * ftl_sim: trace/generator driven FTL simulator (no QEMU, no guest).
+ *
+ * Feeds ssd_write / ssd_read / ssd_trim directly and reports WAF and
+ * throughput, so a policy change can be evaluated in minutes.
+ *
+ * Text trace format (one request per line, '#' starts a comment):
+ *     W <slba> <nlb>      write
+ *     R <slba> <nlb>      read
+ *     D <slba> <nlb>      DSM deallocate (trim), one range
+ */
+#include <errno.h>
+
+#include "ftl_host.h"
+#include "ftl_workload.h"
+
+struct sim_opts {
+    BbCtrlParams bp;
+
+    const char *trace;      /* NULL이면 generator 사용 */
+    const char *gen;        /* workload spec (ftl_workload.h) */
+    uint64_t ops;           /* generator 요청 수 */
+    uint32_t bs;            /* stream 기본 요청 크기 (sectors) */
+    double span;            /* generator가 쓰는 LBA 범위 (장치 대비 비율) */
+    int read_pct;           /* generator 읽기 비율 (%) */
+    uint64_t seed;
+    double precond;         /* 측정 전 span 기준 덮어쓰기 횟수 */
+
+    int64_t iat_ns;         /* 요청 간 가상 도착 간격 */
+    uint64_t burst_len;     /* 0이 아니면 이 요청 수마다 burst_gap_ns 만큼 쉼 */
+    int64_t burst_gap_ns;
+    uint64_t report;        /* N 요청마다 중간 통계 (0이면 끝에만) */
+    bool lun_stats;         /* 끝에 LUN별 I/O 통계도 출력 */
+    bool wear_stats;        /* 끝에 line erase 분포도 출력 */
+};
+
+struct sim_stats {
+    uint64_t reqs[3];       /* write, read, trim */
+};
+
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            FTL_HOST_GEOM_USAGE
+            "workload:\n"
+            "  --trace FILE        replay a text trace ('-' for stdin)\n"
+            "  --gen SPEC          workload streams, see ftl_workload.h (default rand)\n"
+            "                      e.g. zipf:theta=0.99:w=4+seq:bs=256:w=1\n"
+            "  --ops N             measured requests (default 10 x device pages)\n"
+            "  --bs N              default request size in sectors (default 8)\n"
+            "  --span F            fraction of the LBA space used (default 0.7)\n"
+            "  --read-pct P        generator read percentage (default 0)\n"
+            "  --seed N            generator seed (default 1)\n"
+            "  --precond F         fill the span sequentially, then run the workload\n"
+            "                      for F x span pages before measuring (default 0)\n"
+            "timing/report:\n"
+            "  --iat NS            virtual inter-arrival time (default 10000)\n"
+            "  --burst N:NS        idle for NS after every N measured requests\n"
+            "  --report N          print WAF statistics every N requests\n"
+            "  --lun-stats         also print per-LUN utilization at the end\n"
+            "  --wear-stats        also print the line erase-count distribution\n",
+            prog);
+}
+
+static void parse_opts(struct sim_opts *o, int argc, char **argv)
+{
+    static const struct option longopts[] = {
+        FTL_HOST_GEOM_OPTS,
+        { "trace",          required_argument, NULL, 't' },
+        { "gen",            required_argument, NULL, 'w' },
+        { "ops",            required_argument, NULL, 'n' },
+        { "bs",             required_argument, NULL, 's' },
+        { "span",           required_argument, NULL, 'S' },
+        { "read-pct",       required_argument, NULL, 'r' },
+        { "seed",           required_argument, NULL, 'x' },
+        { "precond",        required_argument, NULL, 'P' },
+        { "iat",            required_argument, NULL, 'i' },
+        { "burst",          required_argument, NULL, 'B' },
+        { "report",         required_argument, NULL, 'R' },
+        { "lun-stats",      no_argument,       NULL, 'L' },
+        { "wear-stats",     no_argument,       NULL, 'E' },
+        { "help",           no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int c;
+
+    ftl_host_default_params(&o->bp);
+    o->trace = NULL;
+    o->gen = "rand";
+    o->ops = 0;
+    o->bs = 8;
+    o->span = 0.7;
+    o->read_pct = 0;
+    o->seed = 1;
+    o->precond = 0;
+    o->iat_ns = 10000;
+    o->burst_len = 0;
+    o->burst_gap_ns = 0;
+    o->report = 0;
+    o->lun_stats = false;
+    o->wear_stats = false;
+
+    while ((c = getopt_long(argc, argv, "h", longopts, NULL)) != -1) {
+        if (ftl_host_geom_opt(&o->bp, c, optarg)) {
+            continue;
+        }
+        switch (c) {
+        case 't': o->trace = optarg; break;
+        case 'w': o->gen = optarg; break;
+        case 'n': o->ops = strtoull(optarg, NULL, 0); break;
+        case 's': o->bs = strtoul(optarg, NULL, 0); break;
+        case 'S': o->span = atof(optarg); break;
+        case 'r': o->read_pct = atoi(optarg); break;
+        case 'x': o->seed = strtoull(optarg, NULL, 0); break;
+        case 'P': o->precond = atof(optarg); break;
+        case 'i': o->iat_ns = strtoll(optarg, NULL, 0); break;
+        case 'B':
+            if (sscanf(optarg, "%" SCNu64 ":%" SCNd64, &o->burst_len,
+                       &o->burst_gap_ns) != 2) {
+                fprintf(stderr, "invalid --burst: %s\n", optarg);
+                exit(1);
+            }
+            break;
+        case 'R': o->report = strtoull(optarg, NULL, 0); break;
+        case 'L': o->lun_stats = true; break;
+        case 'E': o->wear_stats = true; break;
+        case 'h':
+        default:
+            usage(argv[0]);
+            exit(c == 'h' ? 0 : 1);
+        }
+    }
+
+    if (o->bs == 0 || o->bs > UINT16_MAX || o->span <= 0 || o->span > 1 ||
+        o->precond < 0) {
+        fprintf(stderr, "invalid --bs, --span or --precond\n");
+        exit(1);
+    }
+}
+
+/* 요청 하나를 FTL에 넣고 latency 반환 */
+static uint64_t sim_submit(struct ssd *ssd, struct sim_stats *st, int op,
+                           uint64_t slba, uint32_t nlb, int64_t now)
+{
+    NvmeRequest req;
+    uint64_t lat;
+    int k;
+
+    memset(&req, 0, sizeof(req));
+    req.slba = slba;
+    req.nlb = nlb;
+    req.stime = now;
+
+    switch (op) {
+    case 'W':
+        req.cmd.opcode = NVME_CMD_WRITE;
+        k = 0;
+        break;
+    case 'R':
+        req.cmd.opcode = NVME_CMD_READ;
+        k = 1;
+        break;
+    default:
+        /* ssd_trim()이 dsm_ranges를 g_free 하므로 요청마다 할당 */
+        req.cmd.opcode = NVME_CMD_DSM;
+        req.dsm_ranges = g_malloc0(sizeof(NvmeDsmRange));
+        req.dsm_ranges[0].slba = slba;
+        req.dsm_ranges[0].nlb = nlb;
+        req.dsm_nr_ranges = 1;
+        k = 2;
+        break;
+    }
+
+    lat = ftl_host_submit(ssd, &req, 1);
+    st->reqs[k]++;
+
+    return lat;
+}
+
+/* i번째 측정 요청을 넣은 뒤 다음 요청의 가상 도착 시각 */
+static int64_t sim_next_arrival(struct sim_opts *o, int64_t now, uint64_t i)
+{
+    now += o->iat_ns;
+    if (o->burst_len && i % o->burst_len == 0) {
+        now += o->burst_gap_ns;
+    }
+    return now;
+}
+
+static void sim_maybe_report(struct sim_opts *o, struct ssd *ssd, uint64_t i)
+{
+    if (o->report && i % o->report == 0) {
+        print_waf_stats(ssd);
+    }
+}
+
+static uint64_t run_trace(struct sim_opts *o, struct ssd *ssd,
+                          struct sim_stats *st)
+{
+    FILE *fp = strcmp(o->trace, "-") ? fopen(o->trace, "r") : stdin;
+    char line[256];
+    uint64_t i = 0, lineno = 0;
+    int64_t now = 0;
+
+    if (!fp) {
+        fprintf(stderr, "cannot open %s: %s\n", o->trace, strerror(errno));
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        char op;
+        uint64_t slba;
+        uint32_t nlb;
+
+        lineno++;
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        if (sscanf(line, " %c %" SCNu64 " %" SCNu32, &op, &slba, &nlb) != 3 ||
+            (op != 'W' && op != 'R' && op != 'D') || nlb == 0 ||
+            nlb > UINT16_MAX) {
+            fprintf(stderr, "%s:%" PRIu64 ": malformed request\n",
+                    o->trace, lineno);
+            continue;
+        }
+
+        femu_stub_set_clock(now);
+        sim_submit(ssd, st, op, slba, nlb, now);
+        now = sim_next_arrival(o, now, ++i);
+        sim_maybe_report(o, ssd, i);
+    }
+
+    if (fp != stdin) {
+        fclose(fp);
+    }
+
+    return i;
+}
+
+/*
+ * 측정 전에 steady state 로: span 전체를 128 KiB 순차 쓰기로 채운 뒤
+ * workload 자체를 precond × span 페이지만큼 돌림. 통계는 초기화하지 않고
+ * (host_writes가 LPN 시퀀스로 쓰이므로) main에서 차이로 계산.
+ */
+static int64_t run_precond(struct sim_opts *o, struct ssd *ssd,
+                           struct workload *wl, uint64_t span_secs)
+{
+    struct sim_stats dummy;
+    uint64_t target, start;
+    int64_t now = 0;
+    uint32_t chunk = 256;
+
+    memset(&dummy, 0, sizeof(dummy));
+    for (uint64_t lba = 0; lba < span_secs; lba += chunk) {
+        uint32_t nlb = span_secs - lba < chunk ? span_secs - lba : chunk;
+
+        femu_stub_set_clock(now);
+        sim_submit(ssd, &dummy, 'W', lba, nlb, now);
+        now += o->iat_ns;
+    }
+
+    start = ssd->host_writes;
+    target = (uint64_t)(o->precond * (span_secs / ssd->sp.secs_per_pg));
+    if (wl->read_pct >= 100) {
+        target = 0;
+    }
+    while (ssd->host_writes - start < target) {
+        uint64_t slba;
+        uint32_t nlb;
+        int op;
+
+        wl_next(wl, &op, &slba, &nlb);
+        if (op != 'W') {
+            continue;
+        }
+        femu_stub_set_clock(now);
+        sim_submit(ssd, &dummy, op, slba, nlb, now);
+        now += o->iat_ns;
+    }
+
+    return now;
+}
+
+static uint64_t run_gen(struct sim_opts *o, struct ssd *ssd,
+                        struct sim_stats *st, struct workload *wl, int64_t now)
+{
+    uint64_t ops = o->ops ? o->ops : (uint64_t)ssd->sp.tt_pgs * 10;
+    uint64_t i;
+
+    for (i = 0; i < ops; i++) {
+        uint64_t slba;
+        uint32_t nlb;
+        int op;
+
+        wl_next(wl, &op, &slba, &nlb);
+        femu_stub_set_clock(now);
+        sim_submit(ssd, st, op, slba, nlb, now);
+        now = sim_next_arrival(o, now, i + 1);
+        sim_maybe_report(o, ssd, i + 1);
+    }
+
+    return i;
+}
+
+int main(int argc, char **argv)
+{
+    static const char *opname[3] = { "write", "read", "trim" };
+    struct sim_opts o;
+    struct sim_stats st;
+    struct workload wl;
+    struct ssd *ssd;
+    FemuCtrl *n;
+    uint64_t nreq, host0 = 0, nand0 = 0, gc0 = 0;
+    int64_t now = 0;
+    double t0, el;
+
+    parse_opts(&o, argc, argv);
+    memset(&st, 0, sizeof(st));
+
+    if (!o.trace && wl_parse(&wl, o.gen, o.bs)) {
+        exit(1);
+    }
+
+    femu_stub_set_clock(0);
+    n = ftl_host_create(&o.bp);
+    ssd = n->ssd;
+
+    if (!o.trace) {
+        uint64_t span_secs = (uint64_t)(ssd->sp.tt_secs * o.span);
+
+        if (wl_setup(&wl, span_secs, o.seed, o.read_pct)) {
+            exit(1);
+        }
+        if (o.precond > 0) {
+            t0 = now_sec();
+            now = run_precond(&o, ssd, &wl, span_secs);
+            printf("ftl_sim: preconditioned %" PRIu64 " pages in %.3f s\n",
+                   ssd->host_writes, now_sec() - t0);
+            host0 = ssd->host_writes;
+            nand0 = ssd->nand_writes;
+            gc0 = ssd->gc_writes;
+            ftl_reset_lat_stats(ssd);
+            ftl_reset_io_stats(ssd);
+        }
+    }
+
+    t0 = now_sec();
+    nreq = o.trace ? run_trace(&o, ssd, &st) : run_gen(&o, ssd, &st, &wl, now);
+    el = now_sec() - t0;
+
+    ftl_trace_close(ssd);
+    ftl_gclog_close(ssd);
+    ftl_stats_close(ssd);
+    print_waf_stats(ssd);
+    ftl_print_prof(ssd);
+    if (o.lun_stats) {
+        ftl_print_lun_stats(ssd);
+    }
+    if (o.wear_stats) {
+        ftl_print_wear_stats(ssd);
+    }
+    ftl_print_lat_stats(ssd);
+
+    if (host0 && ssd->host_writes > host0) {
+        uint64_t dh = ssd->host_writes - host0;
+
+        printf("ftl_sim: steady state: host %" PRIu64 " pages, WAF %.4f, "
+               "GC overhead %.2f%%\n", dh,
+               (double)(ssd->nand_writes - nand0) / dh,
+               (double)(ssd->gc_writes - gc0) / dh * 100.0);
+    }
+
+    printf("ftl_sim: %" PRIu64 " requests in %.3f s (%.2f Mreq/s, %.2f Mpages/s)\n",
+           nreq, el, el > 0 ? nreq / el / 1e6 : 0.0,
+           el > 0 ? (ssd->host_writes - host0) / el / 1e6 : 0.0);
+    for (int i = 0; i < 3; i++) {
+        if (st.reqs[i]) {
+            printf("ftl_sim: %-5s %" PRIu64 " reqs\n", opname[i], st.reqs[i]);
+        }
+    }
+
+    return 0;
+}
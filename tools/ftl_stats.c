@@ -0,0 +1,201 @@
+/*
+ * ftl_stats: samples the shared-memory statistics page published by the FTL
+ * (FEMU_FTL_STATS=<path>) without talking to the FTL thread.
+ *
+ *   ftl_stats /dev/shm/femu-ftl-stats              1초마다 한 줄
+ *   ftl_stats -i 100 -n 50 /dev/shm/femu-ftl-stats 100ms 간격 50번
+ *   ftl_stats --uid -n 1 /dev/shm/femu-ftl-stats   update interval 분포 한 번
+ *
+ * 각 줄의 WAF는 누적값, "int"와 nand 이용률/대기 시간은 직전 샘플 이후 구간의 값.
+ */
+#include <errno.h>
+#include <getopt.h>
+
+#include "ftl.h"
+
+struct stats_opts {
+    const char *path;
+    long interval_ms;
+    long count;             /* 0이면 무한 */
+    bool uid;
+};
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options] STATS_PATH\n"
+            "  -i, --interval MS   sampling interval (default 1000)\n"
+            "  -n, --count N       stop after N samples\n"
+            "  -u, --uid           print the update-interval histogram\n",
+            prog);
+}
+
+static void parse_opts(struct stats_opts *o, int argc, char **argv)
+{
+    static const struct option longopts[] = {
+        { "interval", required_argument, NULL, 'i' },
+        { "count",    required_argument, NULL, 'n' },
+        { "uid",      no_argument,       NULL, 'u' },
+        { "help",     no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int c;
+
+    o->interval_ms = 1000;
+    o->count = 0;
+    o->uid = false;
+
+    while ((c = getopt_long(argc, argv, "i:n:uh", longopts, NULL)) != -1) {
+        switch (c) {
+        case 'i': o->interval_ms = atol(optarg); break;
+        case 'n': o->count = atol(optarg); break;
+        case 'u': o->uid = true; break;
+        case 'h':
+        default:
+            usage(argv[0]);
+            exit(c == 'h' ? 0 : 1);
+        }
+    }
+    if (optind != argc - 1 || o->interval_ms <= 0) {
+        usage(argv[0]);
+        exit(1);
+    }
+    o->path = argv[optind];
+}
+
+static const struct ftl_stats_page *stats_map(const char *path)
+{
+    const struct ftl_stats_page *pg;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+        exit(1);
+    }
+    pg = mmap(NULL, sizeof(*pg), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pg == MAP_FAILED) {
+        fprintf(stderr, "cannot mmap %s: %s\n", path, strerror(errno));
+        exit(1);
+    }
+    if (memcmp(pg->magic, FTL_STATS_MAGIC, 8) ||
+        pg->version != FTL_STATS_VERSION || pg->size != sizeof(*pg)) {
+        fprintf(stderr, "%s: not an FTL stats page (or different version)\n",
+                path);
+        exit(1);
+    }
+    return pg;
+}
+
+/* seqlock read: 갱신 중이거나 도중에 바뀌었으면 다시 */
+static void stats_snapshot(const struct ftl_stats_page *pg,
+                           struct ftl_stats_page *out)
+{
+    uint64_t s1, s2;
+
+    do {
+        s1 = __atomic_load_n(&pg->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1) {
+            continue;
+        }
+        memcpy(out, pg, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        s2 = __atomic_load_n(&pg->seq, __ATOMIC_RELAXED);
+    } while ((s1 & 1) || s1 != s2);
+}
+
+static double ratio(uint64_t num, uint64_t den)
+{
+    return den ? (double)num / den : 0.0;
+}
+
+static void print_sample(const struct ftl_stats_page *s,
+                         struct ftl_stats_page *prev)
+{
+    uint64_t dh = s->host_writes - prev->host_writes;
+    uint64_t dn = s->nand_writes - prev->nand_writes;
+    double span = (double)(s->io_end - prev->io_end) * s->tt_luns;
+    uint64_t duops = 0;
+
+    /* NAND 이용률과 user 대기 시간은 직전 샘플 이후 구간 (중간에 초기화됐으면 처음부터) */
+    if (s->io_t0 != prev->io_t0) {
+        memset(&prev->io, 0, sizeof(prev->io));
+        span = (double)(s->io_end - s->io_t0) * s->tt_luns;
+    }
+    for (int c = 0; c < 3; c++) {
+        duops += s->io.ops[USER_IO][c] - prev->io.ops[USER_IO][c];
+    }
+
+    printf("t=%.3fs host=%" PRIu64 " WAF=%.3f int=%.3f",
+           s->stime / 1e9, s->host_writes,
+           ratio(s->nand_writes, s->host_writes), ratio(dn, dh));
+    for (int c = s->nr_temps - 1; c >= 0 && c < FTL_MAX_TEMPS; c--) {
+        printf(" | %s WAF=%.3f gc=%" PRIu64 " erase=%" PRIu64 " free=%d victim=%d lines=%d/%d",
+               ftl_temp_name(s->nr_temps, c),
+               1.0 + ratio(s->pool_gc_writes[c], s->pool_host_writes[c]),
+               s->pool_gc_cnt[c], s->pool_erases[c],
+               s->free_line_cnt[c], s->victim_line_cnt[c],
+               s->pool_lines[c], s->pool_target[c]);
+    }
+    printf("\n");
+    printf("    nand util user=%.1f%% gc=%.1f%% | user wait %.1fus (behind gc %.0f%%)\n",
+           span > 0 ? 100.0 * (s->io.busy_ns[USER_IO] - prev->io.busy_ns[USER_IO]) / span : 0.0,
+           span > 0 ? 100.0 * (s->io.busy_ns[GC_IO] - prev->io.busy_ns[GC_IO]) / span : 0.0,
+           duops ? (s->io.wait_ns[USER_IO] - prev->io.wait_ns[USER_IO]) / 1e3 / duops : 0.0,
+           100.0 * ratio(s->io.wait_gc_ns - prev->io.wait_gc_ns,
+                         s->io.wait_ns[USER_IO] - prev->io.wait_ns[USER_IO]));
+    printf("    line erase min=%d max=%d | static WL %" PRIu64 " lines (%" PRIu64 " pages)\n",
+           s->erase_min, s->erase_max, s->wl_moves, s->wl_writes);
+    printf("    temp bounds");
+    for (int c = s->nr_temps - 1; c > 0 && c < FTL_MAX_TEMPS; c--) {
+        printf(" %s<=%" PRIu64, ftl_temp_name(s->nr_temps, c), s->temp_bound[c]);
+    }
+    printf(" | UID tune %" PRIu64 " changes, decay window %" PRIu64
+           " | pool resize %" PRIu64 " lines moved\n",
+           s->uid_tunes, s->decay_window, s->pool_moves);
+}
+
+static void print_uid(const struct ftl_stats_page *s)
+{
+    uint64_t total = 0;
+
+    for (int b = 0; b < (int)UID_HIST_BINS; b++) {
+        total += s->uid_hist[b];
+    }
+    for (int b = 0; b < (int)UID_HIST_BINS; b++) {
+        if (s->uid_hist[b]) {
+            printf("  uid[2^%-2d] %12" PRIu64 " (%5.2f%%)\n", b, s->uid_hist[b],
+                   100.0 * ratio(s->uid_hist[b], total));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    struct stats_opts o;
+    const struct ftl_stats_page *pg;
+    struct ftl_stats_page cur, prev;
+
+    parse_opts(&o, argc, argv);
+    pg = stats_map(o.path);
+
+    /* 첫 줄의 구간 값은 마지막 통계 초기화 이후 누적 */
+    stats_snapshot(pg, &cur);
+    memset(&prev, 0, sizeof(prev));
+    prev.io_t0 = cur.io_t0;
+    prev.stime = cur.io_t0;
+    for (long i = 0; !o.count || i < o.count; i++) {
+        if (i) {
+            usleep(o.interval_ms * 1000);
+        }
+        stats_snapshot(pg, &cur);
+        print_sample(&cur, &prev);
+        if (o.uid) {
+            print_uid(&cur);
+        }
+        fflush(stdout);
+        prev = cur;
+    }
+
+    return 0;
+}
@@ -0,0 +1,337 @@
+/*
+ * In-process synthetic workloads (see ftl_workload.h for the spec syntax).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ftl_workload.h"
+
+static const char *wl_type_name[] = {
+    [WL_SEQ]     = "seq",
+    [WL_RAND]    = "rand",
+    [WL_ZIPF]    = "zipf",
+    [WL_HOTCOLD] = "hotcold",
+    [WL_GROUPS]  = "groups",
+};
+
+static uint64_t gcd_u64(uint64_t a, uint64_t b)
+{
+    while (b) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* "10@60,20@30,70@10" → grp_space / grp_cum_w (합이 1이 되도록 정규화) */
+static int wl_parse_groups(struct wl_stream *s, const char *val)
+{
+    char *buf = strdup(val), *save = NULL, *tok;
+    double space_sum = 0, w_sum = 0;
+    double w[WL_MAX_GROUPS];
+    int n = 0;
+
+    for (tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        double sp, wt;
+
+        if (n == WL_MAX_GROUPS || sscanf(tok, "%lf@%lf", &sp, &wt) != 2 ||
+            sp <= 0 || wt < 0) {
+            fprintf(stderr, "workload: bad group '%s' (want SPACE@WRITES)\n", tok);
+            free(buf);
+            return -1;
+        }
+        s->grp_space[n] = sp;
+        w[n] = wt;
+        space_sum += sp;
+        w_sum += wt;
+        n++;
+    }
+    free(buf);
+
+    if (n == 0 || w_sum <= 0) {
+        fprintf(stderr, "workload: groups need at least one group with writes\n");
+        return -1;
+    }
+
+    s->nr_groups = n;
+    for (int i = 0; i < n; i++) {
+        s->grp_space[i] /= space_sum;
+        s->grp_cum_w[i] = (i ? s->grp_cum_w[i - 1] : 0) + w[i] / w_sum;
+    }
+    s->grp_cum_w[n - 1] = 1.0;
+    return 0;
+}
+
+static int wl_parse_stream(struct wl_stream *s, char *str, uint32_t def_bs)
+{
+    char *save = NULL;
+    char *tok = strtok_r(str, ":", &save);
+    double hot = 0.2, prob = 0.8;
+    bool have_groups = false;
+    int t;
+
+    memset(s, 0, sizeof(*s));
+    s->type = -1;
+    for (t = 0; t < (int)(sizeof(wl_type_name) / sizeof(wl_type_name[0])); t++) {
+        if (tok && !strcmp(tok, wl_type_name[t])) {
+            s->type = t;
+        }
+    }
+    if (s->type < 0) {
+        fprintf(stderr, "workload: unknown stream type '%s'\n", tok ? tok : "");
+        return -1;
+    }
+
+    s->bs = def_bs;
+    s->weight = 1.0;
+    s->off = 0.0;
+    s->len = 1.0;
+    s->theta = 0.99;
+    s->scramble = true;
+
+    while ((tok = strtok_r(NULL, ":", &save))) {
+        char *val = strchr(tok, '=');
+
+        if (!val) {
+            fprintf(stderr, "workload: expected key=value, got '%s'\n", tok);
+            return -1;
+        }
+        *val++ = '\0';
+
+        if (!strcmp(tok, "bs")) {
+            s->bs = strtoul(val, NULL, 0);
+        } else if (!strcmp(tok, "w")) {
+            s->weight = atof(val);
+        } else if (!strcmp(tok, "off")) {
+            s->off = atof(val);
+        } else if (!strcmp(tok, "len")) {
+            s->len = atof(val);
+        } else if (!strcmp(tok, "theta") && s->type == WL_ZIPF) {
+            s->theta = atof(val);
+        } else if (!strcmp(tok, "scramble") && s->type == WL_ZIPF) {
+            s->scramble = atoi(val) != 0;
+        } else if (!strcmp(tok, "hot") && s->type == WL_HOTCOLD) {
+            hot = atof(val);
+        } else if (!strcmp(tok, "prob") && s->type == WL_HOTCOLD) {
+            prob = atof(val);
+        } else if (!strcmp(tok, "g") && s->type == WL_GROUPS) {
+            if (wl_parse_groups(s, val)) {
+                return -1;
+            }
+            have_groups = true;
+        } else {
+            fprintf(stderr, "workload: unknown key '%s' for %s\n", tok,
+                    wl_type_name[s->type]);
+            return -1;
+        }
+    }
+
+    if (s->bs == 0 || s->bs > UINT16_MAX || s->weight <= 0 ||
+        s->off < 0 || s->len <= 0 || s->off + s->len > 1.0 + 1e-9) {
+        fprintf(stderr, "workload: bad bs/w/off/len for %s\n",
+                wl_type_name[s->type]);
+        return -1;
+    }
+    if (s->type == WL_ZIPF && (s->theta < 0 || s->theta >= 1)) {
+        fprintf(stderr, "workload: zipf theta must be in [0, 1)\n");
+        return -1;
+    }
+    if (s->type == WL_HOTCOLD) {
+        if (hot <= 0 || hot >= 1 || prob < 0 || prob > 1) {
+            fprintf(stderr, "workload: hotcold needs 0 < hot < 1, 0 <= prob <= 1\n");
+            return -1;
+        }
+        /* 2-group 특수형 */
+        s->nr_groups = 2;
+        s->grp_space[0] = hot;
+        s->grp_space[1] = 1 - hot;
+        s->grp_cum_w[0] = prob;
+        s->grp_cum_w[1] = 1.0;
+    }
+    if (s->type == WL_GROUPS && !have_groups) {
+        fprintf(stderr, "workload: groups needs g=SPACE@WRITES,...\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int wl_parse(struct workload *wl, const char *spec, uint32_t def_bs)
+{
+    char *buf = strdup(spec), *save = NULL, *tok;
+    double w_sum = 0;
+
+    memset(wl, 0, sizeof(*wl));
+    for (tok = strtok_r(buf, "+", &save); tok; tok = strtok_r(NULL, "+", &save)) {
+        if (wl->nr == WL_MAX_STREAMS) {
+            fprintf(stderr, "workload: at most %d streams\n", WL_MAX_STREAMS);
+            free(buf);
+            return -1;
+        }
+        if (wl_parse_stream(&wl->s[wl->nr], tok, def_bs)) {
+            free(buf);
+            return -1;
+        }
+        w_sum += wl->s[wl->nr].weight;
+        wl->nr++;
+    }
+    free(buf);
+
+    if (wl->nr == 0) {
+        fprintf(stderr, "workload: empty spec\n");
+        return -1;
+    }
+    for (int i = 0; i < wl->nr; i++) {
+        wl->cum_w[i] = (i ? wl->cum_w[i - 1] : 0) + wl->s[i].weight / w_sum;
+    }
+    wl->cum_w[wl->nr - 1] = 1.0;
+
+    return 0;
+}
+
+static void wl_setup_zipf(struct wl_stream *s, uint64_t seed)
+{
+    uint64_t n = s->nr_slots;
+    double zeta2;
+
+    s->zeta_n = 0;
+    for (uint64_t i = 1; i <= n; i++) {
+        s->zeta_n += 1.0 / pow((double)i, s->theta);
+    }
+    zeta2 = 1.0 + pow(0.5, s->theta);
+    s->half_pow_theta = pow(0.5, s->theta);
+    s->alpha = 1.0 / (1.0 - s->theta);
+    s->eta = n > 2 ? (1.0 - pow(2.0 / n, 1.0 - s->theta)) / (1.0 - zeta2 / s->zeta_n)
+                   : 1.0;
+
+    /* rank → slot 순열: gcd(mul, n) == 1 이면 (rank * mul + off) % n 은 전단사 */
+    s->perm_mul = 2654435761ULL;
+    while (gcd_u64(s->perm_mul, n) != 1) {
+        s->perm_mul += 2;
+    }
+    s->perm_off = seed % n;
+}
+
+int wl_setup(struct workload *wl, uint64_t span_secs, uint64_t seed,
+             int read_pct)
+{
+    wl->rng = seed ? seed : 1;
+    wl->read_pct = read_pct;
+
+    for (int i = 0; i < wl->nr; i++) {
+        struct wl_stream *s = &wl->s[i];
+        uint64_t start = (uint64_t)(span_secs * s->off);
+        uint64_t size = (uint64_t)(span_secs * s->len);
+
+        s->base = (start + s->bs - 1) / s->bs * s->bs;
+        s->nr_slots = s->base < start + size ? (start + size - s->base) / s->bs : 0;
+        if (s->base + s->nr_slots * s->bs > span_secs) {
+            s->nr_slots = (span_secs - s->base) / s->bs;
+        }
+        if (s->nr_slots < 2) {
+            fprintf(stderr, "workload: %s stream region too small\n",
+                    wl_type_name[s->type]);
+            return -1;
+        }
+        s->seq_next = 0;
+
+        if (s->type == WL_ZIPF) {
+            wl_setup_zipf(s, seed);
+        } else if (s->type == WL_HOTCOLD || s->type == WL_GROUPS) {
+            double acc = 0;
+
+            s->grp_start[0] = 0;
+            for (int g = 0; g < s->nr_groups; g++) {
+                acc += s->grp_space[g];
+                s->grp_start[g + 1] = (uint64_t)(s->nr_slots * acc + 0.5);
+                if (s->grp_start[g + 1] <= s->grp_start[g]) {
+                    s->grp_start[g + 1] = s->grp_start[g] + 1;
+                }
+            }
+            s->grp_start[s->nr_groups] = s->nr_slots;
+            for (int g = 0; g < s->nr_groups; g++) {
+                if (s->grp_start[g] >= s->grp_start[g + 1]) {
+                    fprintf(stderr, "workload: group %d has no space\n", g);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+static uint64_t wl_zipf_slot(struct workload *wl, struct wl_stream *s)
+{
+    double u = wl_rand_unit(wl);
+    double uz = u * s->zeta_n;
+    uint64_t rank;
+
+    if (uz < 1.0) {
+        rank = 0;
+    } else if (uz < 1.0 + s->half_pow_theta) {
+        rank = 1;
+    } else {
+        rank = (uint64_t)(s->nr_slots * pow(s->eta * u - s->eta + 1.0, s->alpha));
+        if (rank >= s->nr_slots) {
+            rank = s->nr_slots - 1;
+        }
+    }
+
+    if (!s->scramble) {
+        return rank;
+    }
+    return (uint64_t)(((unsigned __int128)rank * s->perm_mul + s->perm_off) %
+                      s->nr_slots);
+}
+
+void wl_next(struct workload *wl, int *op, uint64_t *slba, uint32_t *nlb)
+{
+    struct wl_stream *s = &wl->s[0];
+    uint64_t slot;
+
+    if (wl->nr > 1) {
+        double u = wl_rand_unit(wl);
+        int i = 0;
+
+        while (i < wl->nr - 1 && u >= wl->cum_w[i]) {
+            i++;
+        }
+        s = &wl->s[i];
+    }
+
+    switch (s->type) {
+    case WL_SEQ:
+        slot = s->seq_next;
+        if (++s->seq_next == s->nr_slots) {
+            s->seq_next = 0;
+        }
+        break;
+    case WL_ZIPF:
+        slot = wl_zipf_slot(wl, s);
+        break;
+    case WL_HOTCOLD:
+    case WL_GROUPS: {
+        double u = wl_rand_unit(wl);
+        int g = 0;
+
+        while (g < s->nr_groups - 1 && u >= s->grp_cum_w[g]) {
+            g++;
+        }
+        slot = s->grp_start[g] +
+               wl_rand(wl) % (s->grp_start[g + 1] - s->grp_start[g]);
+        break;
+    }
+    case WL_RAND:
+    default:
+        slot = wl_rand(wl) % s->nr_slots;
+        break;
+    }
+
+    *op = (wl->read_pct && (int)(wl_rand(wl) % 100) < wl->read_pct) ? 'R' : 'W';
+    *slba = s->base + slot * s->bs;
+    *nlb = s->bs;
+}
@@ -0,0 +1,99 @@
+/*
+ * In-process synthetic workloads for the host tools.
+ *
+ * A workload is one or more streams joined with '+'. Each request picks a
+ * stream by weight, so "zipf:w=4+seq:bs=256:w=1" interleaves four 4 KiB Zipf
+ * writes with one 128 KiB sequential write, like the fio jobs in README.
+ *
+ *   stream  := type[:key=value]...
+ *   type    := seq | rand | zipf | hotcold | groups
+ *
+ * Common keys:
+ *   bs=N       request size in sectors (default: --bs)
+ *   w=F        stream weight (default 1)
+ *   off=F      start of the stream's region, fraction of the span (default 0)
+ *   len=F      size of the stream's region, fraction of the span (default 1)
+ *
+ * Type-specific keys:
+ *   zipf       theta=F     skew, 0 <= theta < 1 (default 0.99)
+ *              scramble=0  keep hot ranks adjacent instead of scattering them
+ *   hotcold    hot=F       hot fraction of the region (default 0.2)
+ *              prob=F      fraction of writes that go to the hot part (default 0.8)
+ *   groups     g=S@W,...   MiDAS-style update-interval groups: group i gets
+ *                          S% of the region and W% of the writes, so its
+ *                          update interval is ~ S/W region-sized passes
+ */
+#ifndef __FTL_WORKLOAD_H
+#define __FTL_WORKLOAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WL_MAX_STREAMS      (8)
+#define WL_MAX_GROUPS       (16)
+
+enum {
+    WL_SEQ     = 0,
+    WL_RAND    = 1,
+    WL_ZIPF    = 2,
+    WL_HOTCOLD = 3,
+    WL_GROUPS  = 4,
+};
+
+struct wl_stream {
+    int type;
+    uint32_t bs;
+    double weight;
+    double off, len;
+
+    uint64_t base;          /* 첫 slot의 LBA */
+    uint64_t nr_slots;      /* bs 크기 slot 수 */
+    uint64_t seq_next;
+
+    /* zipf (Gray et al., "Quickly generating billion-record synthetic databases") */
+    double theta;
+    double zeta_n, alpha, eta, half_pow_theta;
+    bool scramble;
+    uint64_t perm_mul, perm_off;
+
+    /* hotcold / groups: 누적 비율 테이블 */
+    int nr_groups;
+    double grp_space[WL_MAX_GROUPS];
+    double grp_cum_w[WL_MAX_GROUPS];
+    uint64_t grp_start[WL_MAX_GROUPS + 1];
+};
+
+struct workload {
+    int nr;
+    struct wl_stream s[WL_MAX_STREAMS];
+    double cum_w[WL_MAX_STREAMS];
+    int read_pct;
+    uint64_t rng;
+};
+
+/* 0 on success, -1 (with a message on stderr) on a bad spec */
+int wl_parse(struct workload *wl, const char *spec, uint32_t def_bs);
+
+/* span_secs 범위 안에 stream 영역을 배치하고 zipf 상수 등을 계산 */
+int wl_setup(struct workload *wl, uint64_t span_secs, uint64_t seed,
+             int read_pct);
+
+/* 다음 요청; op 는 'W' 또는 'R' */
+void wl_next(struct workload *wl, int *op, uint64_t *slba, uint32_t *nlb);
+
+/* xorshift64* */
+static inline uint64_t wl_rand(struct workload *wl)
+{
+    wl->rng ^= wl->rng >> 12;
+    wl->rng ^= wl->rng << 25;
+    wl->rng ^= wl->rng >> 27;
+    return wl->rng * 2685821657736338717ULL;
+}
+
+/* [0, 1) */
+static inline double wl_rand_unit(struct workload *wl)
+{
+    return (wl_rand(wl) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+#endif